@@ -4,10 +4,6 @@ import sys
 _2pi = 2 * math.pi
 _4pi = 4 * math.pi
 
-def generate_sin_table(len):
-   for i in range(len):
-      yield math.sin(_2pi * i/len)
-
 def generate_hamming_table(len):
    for i in range(len):
       yield 0.54 - 0.46 * math.cos(_2pi*i/len)
@@ -30,9 +26,7 @@ if __name__ == "__main__":
       columns = int(sys.argv[2])
 
    func = None
-   if what == "sin":
-      func = generate_sin_table
-   elif what == "hamming":
+   if what == "hamming":
       func = generate_hamming_table
    elif what == "blackman":
          func = generate_blackman_table
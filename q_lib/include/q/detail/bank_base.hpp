@@ -0,0 +1,66 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_BANK_BASE_OCTOBER_19_2026)
+#define CYCFI_Q_BANK_BASE_OCTOBER_19_2026
+
+#include <array>
+#include <cstddef>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // frame: one sample of N channels (lanes), the unit processed by the
+   // SoA (structure of arrays) banks, e.g. envelope_bank.hpp and
+   // lowpass_bank.hpp.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   using frame = std::array<float, N>;
+
+   namespace detail
+   {
+      ////////////////////////////////////////////////////////////////////////
+      // bank_base: CRTP base of the SoA banks. The Derived class provides
+      // the per-frame function call operator, operator()(frame const&),
+      // returning its _y frame. bank_base provides the latest frame,
+      // operator()(), and block processing, process(in, out, n), given N
+      // input channels and N output channels.
+      ////////////////////////////////////////////////////////////////////////
+      template <typename Derived, std::size_t N>
+      struct bank_base
+      {
+         using frame_type = frame<N>;
+         using in_channels = std::array<float const*, N>;
+         using out_channels = std::array<float*, N>;
+
+         static constexpr std::size_t num_lanes = N;
+
+         frame_type const& operator()() const
+         {
+            return derived()._y;
+         }
+
+         void process(in_channels const& in, out_channels const& out, std::size_t n)
+         {
+            for (std::size_t i = 0; i != n; ++i)
+            {
+               frame_type s;
+               for (std::size_t k = 0; k != N; ++k)
+                  s[k] = in[k][i];
+               auto const& y = derived()(s);
+               for (std::size_t k = 0; k != N; ++k)
+                  out[k][i] = y[k];
+            }
+         }
+
+      protected:
+
+         Derived& derived() { return static_cast<Derived&>(*this); }
+         Derived const& derived() const { return static_cast<Derived const&>(*this); }
+      };
+   }
+}
+
+#endif
@@ -0,0 +1,57 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_PREFIX_SUM_OCTOBER_19_2026)
+#define CYCFI_Q_PREFIX_SUM_OCTOBER_19_2026
+
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define CYCFI_Q_PREFIX_SUM_SSE2
+# include <emmintrin.h>
+#endif
+
+namespace cycfi::q::detail
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // In-place inclusive prefix sum (scan): data[i] = carry + data[0] + ...
+   // + data[i]. Returns the last sum (the carry for the next block).
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T>
+   inline T prefix_sum(T* data, std::size_t n, T carry)
+   {
+      for (std::size_t i = 0; i != n; ++i)
+         data[i] = carry += data[i];
+      return carry;
+   }
+
+#if defined(CYCFI_Q_PREFIX_SUM_SSE2)
+   // The SSE2 version scans 4 samples at a time in-register (two shifted
+   // adds), leaving only one add per 4 samples in the carry dependency
+   // chain.
+   inline float prefix_sum(float* data, std::size_t n, float carry)
+   {
+      std::size_t i = 0;
+      __m128 c = _mm_set1_ps(carry);
+      for (; i + 4 <= n; i += 4)
+      {
+         __m128 x = _mm_loadu_ps(data + i);
+         x = _mm_add_ps(x, _mm_castsi128_ps(
+            _mm_slli_si128(_mm_castps_si128(x), 4)));
+         x = _mm_add_ps(x, _mm_castsi128_ps(
+            _mm_slli_si128(_mm_castps_si128(x), 8)));
+         x = _mm_add_ps(x, c);
+         _mm_storeu_ps(data + i, x);
+         c = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+      }
+      carry = _mm_cvtss_f32(c);
+      for (; i < n; ++i)
+         data[i] = carry += data[i];
+      return carry;
+   }
+#endif
+}
+
+#endif
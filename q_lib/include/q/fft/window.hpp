@@ -0,0 +1,232 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_WINDOW_HPP_OCTOBER_19_2026)
+#define CYCFI_Q_WINDOW_HPP_OCTOBER_19_2026
+
+#include <q/support/base.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Window functions for analysis frames (e.g. FFT and STFT).
+   //
+   //    hann              0.5 - 0.5 cos(x)
+   //    hamming           0.54 - 0.46 cos(x)
+   //    blackman          0.42 - 0.5 cos(x) + 0.08 cos(2x)
+   //    blackman_harris   4-term Blackman-Harris (-92 dB side lobes)
+   //    nuttall           4-term Nuttall, with a continuous first
+   //                      derivative (-93 dB side lobes)
+   //    flat_top          5-term flat top, for amplitude measurements
+   //                      (less than 0.01 dB scalloping loss)
+   //    kaiser            I0(beta sqrt(1 - (2n/M - 1)^2)) / I0(beta), where
+   //                      beta trades the main lobe width for the side
+   //                      lobe level (e.g. beta = 8.6: -63 dB side lobes,
+   //                      beta = 12: -90 dB side lobes)
+   //
+   // where x = 2pi n/M, for n in [0, N). The window is periodic (M = N) by
+   // default, as needed for the DFT (e.g. a periodic Hann window with 50%
+   // overlap adds up to a constant). Symmetric windows (M = N - 1) are for
+   // filter design.
+   ////////////////////////////////////////////////////////////////////////////
+   enum class window_type
+   {
+      hann
+    , hamming
+    , blackman
+    , blackman_harris
+    , nuttall
+    , flat_top
+    , kaiser
+   };
+
+   struct window_spec
+   {
+      window_type    type;
+      std::size_t    size;
+      bool           symmetric = false;
+      float          beta = 8.6f;         // Kaiser window only
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // window_table: A precomputed window, aligned to window_table::alignment
+   // bytes (a cache line, and the widest SIMD vectors), computed in double
+   // precision.
+   //
+   // apply(in, out) multiplies size() samples by the window, one multiply
+   // per sample, in a loop that the compiler can vectorize. in and out may
+   // be the same buffer.
+   //
+   // Use window(spec) to get a cached table, computed once per spec and
+   // shared (read only) by all users, e.g. all the analysis frames of an
+   // STFT. apply_window(w, in, out, n) is the windowing kernel, given the
+   // window's samples.
+   ////////////////////////////////////////////////////////////////////////////
+   class window_table
+   {
+   public:
+
+      static constexpr std::size_t alignment = 64;
+
+      explicit             window_table(window_spec const& spec);
+
+      float const*         data() const               { return _data.get(); }
+      std::size_t          size() const               { return _spec.size; }
+      float                operator[](std::size_t i) const { return _data[i]; }
+      window_spec const&   spec() const               { return _spec; }
+
+      float const*         begin() const              { return data(); }
+      float const*         end() const                { return data() + size(); }
+
+      float                coherent_gain() const      { return _gain; }
+      void                 apply(float const* in, float* out) const;
+
+   private:
+
+      struct aligned_delete
+      {
+         void operator()(float* p) const
+         {
+            ::operator delete[](p, std::align_val_t{alignment});
+         }
+      };
+
+      window_spec          _spec;
+      std::unique_ptr<float[], aligned_delete> _data;
+      float                _gain;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   namespace detail
+   {
+      // Zeroth order modified Bessel function of the first kind
+      inline double bessel_i0(double x)
+      {
+         double sum = 1.0;
+         double term = 1.0;
+         double const q = x * x / 4;
+         for (int k = 1; k != 500; ++k)
+         {
+            term *= q / (double(k) * k);
+            sum += term;
+            if (term < sum * 1e-17)
+               break;
+         }
+         return sum;
+      }
+
+      template <std::size_t K>
+      inline double cosine_sum(double const (&a)[K], double x)
+      {
+         double w = 0.0;
+         double sign = 1.0;
+         for (std::size_t k = 0; k != K; ++k, sign = -sign)
+            w += sign * a[k] * std::cos(k * x);
+         return w;
+      }
+
+      inline double window_value(window_spec const& spec, std::size_t n)
+      {
+         static constexpr double hann[] = { 0.5, 0.5 };
+         static constexpr double hamming[] = { 0.54, 0.46 };
+         static constexpr double blackman[] = { 0.42, 0.5, 0.08 };
+         static constexpr double blackman_harris[] =
+            { 0.35875, 0.48829, 0.14128, 0.01168 };
+         static constexpr double nuttall[] =
+            { 0.355768, 0.487396, 0.144232, 0.012604 };
+         static constexpr double flat_top[] =
+            { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 };
+
+         auto const m = double(spec.symmetric? spec.size - 1 : spec.size);
+         if (m <= 0.0)
+            return 1.0;
+         auto const x = 2 * pi * n / m;
+
+         switch (spec.type)
+         {
+            case window_type::hann: return cosine_sum(hann, x);
+            case window_type::hamming: return cosine_sum(hamming, x);
+            case window_type::blackman: return cosine_sum(blackman, x);
+            case window_type::blackman_harris: return cosine_sum(blackman_harris, x);
+            case window_type::nuttall: return cosine_sum(nuttall, x);
+            case window_type::flat_top: return cosine_sum(flat_top, x);
+            case window_type::kaiser:
+            default:
+            {
+               auto r = 2.0 * n / m - 1.0;
+               auto beta = double(spec.beta);
+               return bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - r * r)))
+                  / bessel_i0(beta);
+            }
+         }
+      }
+   }
+
+   // Multiply n samples by the window w
+   inline void apply_window(
+      float const* w
+    , float const* in
+    , float* out
+    , std::size_t n
+   )
+   {
+      for (std::size_t i = 0; i != n; ++i)
+         out[i] = in[i] * w[i];
+   }
+
+   inline window_table::window_table(window_spec const& spec)
+    : _spec(spec)
+    , _data(static_cast<float*>(
+         ::operator new[](
+            std::max<std::size_t>(spec.size, 1) * sizeof(float)
+          , std::align_val_t{alignment}
+         )
+      ))
+   {
+      double sum = 0.0;
+      for (std::size_t i = 0; i != spec.size; ++i)
+      {
+         auto w = detail::window_value(spec, i);
+         _data[i] = w;
+         sum += w;
+      }
+      _gain = spec.size? sum / spec.size : 1.0f;
+   }
+
+   inline void window_table::apply(float const* in, float* out) const
+   {
+      apply_window(data(), in, out, size());
+   }
+
+   // Returns the cached window for spec, computing it on first use. The
+   // table is never freed, so the reference stays valid. Thread safe.
+   inline window_table const& window(window_spec const& spec)
+   {
+      using key_type = std::tuple<window_type, std::size_t, bool, float>;
+      static std::map<key_type, std::unique_ptr<window_table>> cache;
+      static std::mutex mutex;
+
+      auto const beta = (spec.type == window_type::kaiser)? spec.beta : 0.0f;
+      auto const key = key_type{ spec.type, spec.size, spec.symmetric, beta };
+
+      std::lock_guard<std::mutex> lock(mutex);
+      auto& table = cache[key];
+      if (!table)
+         table = std::make_unique<window_table>(spec);
+      return *table;
+   }
+}
+
+#endif
@@ -26,22 +26,61 @@ namespace cycfi::q
        , x1(0), x2(0), y1(0), y2(0)
       {}
 
-      float operator()(float s)
+      // The sample delays, for processing with the state kept in local
+      // variables (registers), using step (see process).
+      struct state
+      {
+         float x1, x2, y1, y2;
+      };
+
+      state get_state() const
+      {
+         return { x1, x2, y1, y2 };
+      }
+
+      void set_state(state const& st)
+      {
+         x1 = st.x1;
+         x2 = st.x2;
+         y1 = st.y1;
+         y2 = st.y2;
+      }
+
+      // Process one sample, given the state, and update the state
+      float step(float s, state& st) const
       {
          // compute result
-         auto r = a0 * s + a1 * x1 + a2 * x2 - a3 * y1 - a4 * y2;
+         auto r = a0 * s + a1 * st.x1 + a2 * st.x2 - a3 * st.y1 - a4 * st.y2;
 
          // shift x1 to x2, s to x1
-         x2 = x1;
-         x1 = s;
+         st.x2 = st.x1;
+         st.x1 = s;
 
          // shift y1 to y2, r to y1
-         y2 = y1;
-         y1 = r;
+         st.y2 = st.y1;
+         st.y1 = r;
 
          return r;
       }
 
+      float operator()(float s)
+      {
+         auto st = get_state();
+         auto r = step(s, st);
+         set_state(st);
+         return r;
+      }
+
+      // Process a block of n samples. The state is kept in registers for
+      // the whole block. In-place processing (in == out) is allowed.
+      void process(float const* in, float* out, std::size_t n)
+      {
+         auto st = get_state();
+         for (std::size_t i = 0; i != n; ++i)
+            out[i] = step(in[i], st);
+         set_state(st);
+      }
+
       void config(float a0_, float a1_, float a2_, float a3_, float a4_)
       {
          a0 = a0_;
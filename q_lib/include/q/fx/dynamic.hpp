@@ -7,6 +7,9 @@
 #define CYCFI_Q_DYNAMIC_DECEMBER_7_2018
 
 #include <q/support/base.hpp>
+#include <array>
+#include <cstdint>
+#include <cstring>
 
 namespace cycfi::q
 {
@@ -122,6 +125,62 @@ namespace cycfi::q
       decibel     _max;
    };
 
+   ////////////////////////////////////////////////////////////////////////////
+   // gain_table precomputes the static gain curve of an envelope processor
+   // (e.g. compressor, soft_knee_compressor or expander), with its
+   // threshold, knee, ratio and an optional makeup gain baked in, into a
+   // lookup table. The function call operator, operator()(float env),
+   // takes the envelope as a linear amplitude (not decibels) and returns
+   // the linear gain, replacing the linear to dB conversion, the envelope
+   // processing and the dB to linear conversion with one table lookup:
+   //
+   //    auto gain = table(env);
+   //    auto out = signal * gain;
+   //
+   // The table is indexed by the exponent and the upper mantissa bits of
+   // the IEEE754 float envelope, giving 32 entries per octave (about 0.19
+   // dB) from -120 dB to +48 dB, with linear interpolation in between. Hard
+   // knees are rounded within one table step. Envelopes below the range
+   // take the gain at -120 dB and envelopes above the range take the gain
+   // at +48 dB.
+   //
+   // The table is built at construction and rebuilt only when the
+   // processor or makeup gain changes, through the processor(p) and
+   // makeup(g) mutators.
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename Processor>
+   class gain_table
+   {
+   public:
+
+      static constexpr int resolution_bits = 5;
+      static constexpr int min_exponent = -20;
+      static constexpr int max_exponent = 8;
+      static constexpr std::size_t size =
+         std::size_t(max_exponent - min_exponent) << resolution_bits;
+
+                           gain_table(Processor const& proc, decibel makeup_ = 0_dB);
+
+      float                operator()(float env) const;
+
+      void                 processor(Processor const& proc);
+      void                 makeup(decibel val);
+      Processor const&     processor() const;
+      decibel              makeup() const;
+
+   private:
+
+      static constexpr int mantissa_shift = 23 - resolution_bits;
+      static constexpr std::uint32_t min_bits = std::uint32_t(127 + min_exponent) << 23;
+      static constexpr std::uint32_t max_bits = std::uint32_t(127 + max_exponent) << 23;
+
+      void                 build();
+
+      Processor            _proc;
+      decibel              _makeup;
+      std::array<float, size + 1> _table;
+   };
+
    ////////////////////////////////////////////////////////////////////////////
    // Implementation
    ////////////////////////////////////////////////////////////////////////////
@@ -188,7 +247,7 @@ namespace cycfi::q
       }
    }
 
-   void soft_knee_compressor::threshold(decibel val)
+   inline void soft_knee_compressor::threshold(decibel val)
    {
       _threshold = val;
       _lower = _threshold - (_width * 0.5);
@@ -277,6 +336,73 @@ namespace cycfi::q
    {
       return _max;
    }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // gain_table
+   template <typename Processor>
+   inline gain_table<Processor>::gain_table(Processor const& proc, decibel makeup_)
+    : _proc(proc)
+    , _makeup(makeup_)
+   {
+      build();
+   }
+
+   // Entry i is the gain at the float envelope whose bits are min_bits +
+   // (i << mantissa_shift).
+   template <typename Processor>
+   inline void gain_table<Processor>::build()
+   {
+      for (std::size_t i = 0; i != _table.size(); ++i)
+      {
+         auto bits = min_bits + (std::uint32_t(i) << mantissa_shift);
+         float env;
+         std::memcpy(&env, &bits, sizeof(env));
+         _table[i] = as_float(_proc(decibel(env)) + _makeup);
+      }
+   }
+
+   template <typename Processor>
+   inline float gain_table<Processor>::operator()(float env) const
+   {
+      std::uint32_t bits;
+      std::memcpy(&bits, &env, sizeof(bits));
+      if (bits <= min_bits)
+         return _table[0];
+      if (bits >= max_bits) // including negative envelopes and NaNs
+         return (bits >> 31)? _table[0] : _table[size];
+
+      auto const offset = bits - min_bits;
+      auto const i = offset >> mantissa_shift;
+      auto const frac = (offset & ((1u << mantissa_shift) - 1))
+         * (1.0f / (1u << mantissa_shift));
+      return _table[i] + frac * (_table[i+1] - _table[i]);
+   }
+
+   template <typename Processor>
+   inline void gain_table<Processor>::processor(Processor const& proc)
+   {
+      _proc = proc;
+      build();
+   }
+
+   template <typename Processor>
+   inline void gain_table<Processor>::makeup(decibel val)
+   {
+      _makeup = val;
+      build();
+   }
+
+   template <typename Processor>
+   inline Processor const& gain_table<Processor>::processor() const
+   {
+      return _proc;
+   }
+
+   template <typename Processor>
+   inline decibel gain_table<Processor>::makeup() const
+   {
+      return _makeup;
+   }
 }
 
 #endif
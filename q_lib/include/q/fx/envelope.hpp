@@ -19,6 +19,10 @@ namespace cycfi::q
    // closely tracks the maximum peak level. When the signal level drops
    // below the peak, the follower gradually releases the peak level with an
    // exponential decay.
+   //
+   // All envelope followers provide a block process function,
+   // process(in, out, n), equivalent to n calls to operator()(s). See
+   // envelope_bank.hpp for the multichannel (SoA) variants.
    ////////////////////////////////////////////////////////////////////////////
    struct peak_envelope_follower
    {
@@ -26,6 +30,7 @@ namespace cycfi::q
 
       float                   operator()(float s);
       float                   operator()() const;
+      void                    process(float const* in, float* out, std::size_t n);
       peak_envelope_follower& operator=(float y_);
       void                    release(duration release_, float sps);
 
@@ -48,6 +53,7 @@ namespace cycfi::q
 
       float                   operator()(float s);
       float                   operator()() const;
+      void                    process(float const* in, float* out, std::size_t n);
       ar_envelope_follower&   operator=(float y_);
       void                    config(duration attack, duration release, float sps);
       void                    attack(float attack_, float sps);
@@ -74,6 +80,11 @@ namespace cycfi::q
    // with the same duration as the hold parameter.
    //
    // fast_envelope_follower is provided, which has div = 2.
+   //
+   // The block process function, process(in, out, n), processes the samples
+   // in runs between resets. Within a run, the envelope is simply the
+   // running maximum, so the div+1 staircase steps are updated only once
+   // per run.
    ////////////////////////////////////////////////////////////////////////////
    template <std::size_t div>
    struct basic_fast_envelope_follower
@@ -86,6 +97,7 @@ namespace cycfi::q
 
       float    operator()(float s);
       float    operator()() const;
+      void     process(float const* in, float* out, std::size_t n);
 
       std::array<float, size> _y;
       float _peak = 0;
@@ -108,6 +120,7 @@ namespace cycfi::q
 
       float    operator()(float s);
       float    operator()() const;
+      void     process(float const* in, float* out, std::size_t n);
 
       basic_fast_envelope_follower<div> _fenv;
       moving_average _ma;
@@ -139,6 +152,7 @@ namespace cycfi::q
 
                fast_rms_envelope_follower(duration hold, float sps);
       float    operator()(float s);
+      void     process(float const* in, float* out, std::size_t n);
 
       fast_ave_envelope_follower  _fenv;
    };
@@ -147,9 +161,17 @@ namespace cycfi::q
    {
       using fast_rms_envelope_follower::fast_rms_envelope_follower;
 
-      decibel operator()(float s);
+      decibel  operator()(float s);
+      void     process(float const* in, decibel* out, std::size_t n);
    };
 
+   namespace detail
+   {
+      // Block size of the scratch buffers (on the stack) used by the block
+      // process functions of composite processors.
+      constexpr std::size_t envelope_chunk_size = 64;
+   }
+
    ////////////////////////////////////////////////////////////////////////////
    // Implementation
    ////////////////////////////////////////////////////////////////////////////
@@ -174,6 +196,18 @@ namespace cycfi::q
       return y;
    }
 
+   inline void peak_envelope_follower::process(
+      float const* in, float* out, std::size_t n)
+   {
+      auto y_ = y;
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         auto s = in[i];
+         out[i] = y_ = (s > y_)? s : s + _release * (y_ - s);
+      }
+      y = y_;
+   }
+
    inline peak_envelope_follower& peak_envelope_follower::operator=(float y_)
    {
       y = y_;
@@ -204,6 +238,18 @@ namespace cycfi::q
       return y;
    }
 
+   inline void ar_envelope_follower::process(
+      float const* in, float* out, std::size_t n)
+   {
+      auto y_ = y;
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         auto s = in[i];
+         out[i] = y_ = s + ((s > y_)? _attack : _release) * (y_ - s);
+      }
+      y = y_;
+   }
+
    inline ar_envelope_follower& ar_envelope_follower::operator=(float y_)
    {
       y = y_;
@@ -267,6 +313,41 @@ namespace cycfi::q
       return _peak;
    }
 
+   template <std::size_t div>
+   inline void basic_fast_envelope_follower<div>::process(
+      float const* in, float* out, std::size_t n)
+   {
+      for (std::size_t i = 0; i != n;)
+      {
+         // Process the samples up to and including the next reset. The
+         // envelope is the running maximum of the run and the peak.
+         std::size_t const run = std::min<std::size_t>(n - i, _reset - _tick + 1);
+         float run_max = 0;
+         for (std::size_t j = 0; j != run; ++j)
+         {
+            run_max = std::max(in[i+j], run_max);
+            out[i+j] = std::max(run_max, _peak);
+         }
+         for (auto& y : _y)
+            y = std::max(run_max, y);
+
+         _tick += run;
+         i += run;
+         if (_tick == _reset + 1)
+         {
+            // Reset _y in a round-robin fashion, same as operator()(s)
+            _tick = 0;
+            _y[_i++ % size] = 0;
+            _peak = *std::max_element(_y.begin(), _y.end());
+            out[i-1] = _peak;
+         }
+         else
+         {
+            _peak = out[i-1];
+         }
+      }
+   }
+
    ////////////////////////////////////////////////////////////////////////////
    // basic_fast_ave_envelope_follower<div>
    template <std::size_t div>
@@ -295,6 +376,19 @@ namespace cycfi::q
       return _ma();
    }
 
+   template <std::size_t div>
+   inline void basic_fast_ave_envelope_follower<div>::process(
+      float const* in, float* out, std::size_t n)
+   {
+      float env[detail::envelope_chunk_size];
+      for (std::size_t i = 0; i < n; i += detail::envelope_chunk_size)
+      {
+         auto m = std::min(n - i, detail::envelope_chunk_size);
+         _fenv.process(in + i, env, m);
+         _ma.process(env, out + i, m);
+      }
+   }
+
    ////////////////////////////////////////////////////////////////////////////
    // fast_rms_envelope_follower
    inline fast_rms_envelope_follower::fast_rms_envelope_follower(
@@ -311,6 +405,24 @@ namespace cycfi::q
       return fast_sqrt(e);
    }
 
+   inline void fast_rms_envelope_follower::process(
+      float const* in, float* out, std::size_t n)
+   {
+      float sq[detail::envelope_chunk_size];
+      for (std::size_t i = 0; i < n; i += detail::envelope_chunk_size)
+      {
+         auto m = std::min(n - i, detail::envelope_chunk_size);
+         for (std::size_t j = 0; j != m; ++j)
+            sq[j] = in[i+j] * in[i+j];
+         _fenv.process(sq, out + i, m);
+         for (std::size_t j = 0; j != m; ++j)
+         {
+            auto e = out[i+j];
+            out[i+j] = (e < threshold)? 0.0f : fast_sqrt(e);
+         }
+      }
+   }
+
    ////////////////////////////////////////////////////////////////////////////
    // fast_rms_envelope_follower
    inline decibel fast_rms_envelope_follower_db::operator()(float s)
@@ -320,7 +432,31 @@ namespace cycfi::q
          e = 0;
 
       // Perform square-root in the dB domain:
-      return decibel{e} / 2.0f;
+      return decibel{to_db(e) / 2.0f, decibel::direct};
+   }
+
+   inline void fast_rms_envelope_follower_db::process(
+      float const* in, decibel* out, std::size_t n)
+   {
+      float sq[detail::envelope_chunk_size];
+      float env[detail::envelope_chunk_size];
+      for (std::size_t i = 0; i < n; i += detail::envelope_chunk_size)
+      {
+         auto m = std::min(n - i, detail::envelope_chunk_size);
+         for (std::size_t j = 0; j != m; ++j)
+            sq[j] = in[i+j] * in[i+j];
+         _fenv.process(sq, env, m);
+         for (std::size_t j = 0; j != m; ++j)
+         {
+            if (env[j] < threshold)
+               env[j] = 0;
+         }
+         to_db(env, env, m);
+
+         // Perform square-root in the dB domain:
+         for (std::size_t j = 0; j != m; ++j)
+            out[i+j] = decibel{env[j] / 2.0f, decibel::direct};
+      }
    }
 }
 
@@ -0,0 +1,362 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_FX_ENVELOPE_BANK_OCTOBER_19_2026)
+#define CYCFI_Q_FX_ENVELOPE_BANK_OCTOBER_19_2026
+
+#include <q/fx/envelope.hpp>
+#include <q/detail/bank_base.hpp>
+#include <q/utility/ring_buffer.hpp>
+#include <array>
+#include <algorithm>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Multichannel envelope followers. Each bank tracks N channels (lanes)
+   // with shared parameters, e.g. for stereo or surround dynamics.
+   //
+   // The state is kept in SoA (structure of arrays) layout: one array of N
+   // lanes per state variable. The per-sample function call operator takes
+   // and returns a frame (std::array<float, N>), and all lanes are updated
+   // in branch-free loops that the compiler can vectorize.
+   //
+   // For linked-channel dynamics processing, linked() returns the maximum
+   // envelope across all lanes.
+   //
+   // Block processing is available via process(in, out, n), given N input
+   // channels and N output channels, and process_linked(in, out, n), which
+   // writes the linked (maximum) envelope to a single output channel.
+   ////////////////////////////////////////////////////////////////////////////
+   namespace detail
+   {
+      template <typename Derived, std::size_t N>
+      struct envelope_bank_base : bank_base<Derived, N>
+      {
+         using typename bank_base<Derived, N>::in_channels;
+
+         float linked() const
+         {
+            auto const& y = this->derived()._y;
+            return *std::max_element(y.begin(), y.end());
+         }
+
+         void process_linked(in_channels const& in, float* out, std::size_t n)
+         {
+            for (std::size_t i = 0; i != n; ++i)
+            {
+               frame<N> s;
+               for (std::size_t k = 0; k != N; ++k)
+                  s[k] = in[k][i];
+               this->derived()(s);
+               out[i] = linked();
+            }
+         }
+      };
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // N channel peak_envelope_follower
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   struct peak_envelope_follower_bank
+    : detail::envelope_bank_base<peak_envelope_follower_bank<N>, N>
+   {
+      using base_type = detail::envelope_bank_base<peak_envelope_follower_bank<N>, N>;
+      using base_type::operator();
+
+                                    peak_envelope_follower_bank(duration release, float sps);
+
+      frame<N> const&               operator()(frame<N> const& s);
+      peak_envelope_follower_bank&  operator=(float y_);
+      void                          release(duration release_, float sps);
+
+      frame<N> _y;
+      float _release;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // N channel ar_envelope_follower
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   struct ar_envelope_follower_bank
+    : detail::envelope_bank_base<ar_envelope_follower_bank<N>, N>
+   {
+      using base_type = detail::envelope_bank_base<ar_envelope_follower_bank<N>, N>;
+      using base_type::operator();
+
+                                    ar_envelope_follower_bank(
+                                       duration attack
+                                     , duration release
+                                     , float sps
+                                    );
+
+      frame<N> const&               operator()(frame<N> const& s);
+      ar_envelope_follower_bank&    operator=(float y_);
+      void                          config(duration attack, duration release, float sps);
+
+      frame<N> _y;
+      float _attack, _release;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // N channel basic_fast_envelope_follower
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t div, std::size_t N>
+   struct basic_fast_envelope_follower_bank
+    : detail::envelope_bank_base<basic_fast_envelope_follower_bank<div, N>, N>
+   {
+      static_assert(div >= 1, "div must be >= 1");
+      static constexpr std::size_t size = div+1;
+
+      using base_type = detail::envelope_bank_base<basic_fast_envelope_follower_bank, N>;
+      using base_type::operator();
+
+                        basic_fast_envelope_follower_bank(duration hold, float sps);
+                        basic_fast_envelope_follower_bank(std::size_t hold_samples);
+
+      frame<N> const&   operator()(frame<N> const& s);
+
+      std::array<frame<N>, size> _steps;
+      frame<N> _y;
+      std::uint16_t _tick = 0, _i = 0;
+      std::uint16_t const _reset;
+   };
+
+   template <std::size_t N>
+   using fast_envelope_follower_bank = basic_fast_envelope_follower_bank<2, N>;
+
+   ////////////////////////////////////////////////////////////////////////////
+   // N channel basic_fast_ave_envelope_follower. The moving average of all
+   // lanes shares one ring buffer of frames.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t div, std::size_t N>
+   struct basic_fast_ave_envelope_follower_bank
+    : detail::envelope_bank_base<basic_fast_ave_envelope_follower_bank<div, N>, N>
+   {
+      using base_type = detail::envelope_bank_base<basic_fast_ave_envelope_follower_bank, N>;
+      using base_type::operator();
+
+                        basic_fast_ave_envelope_follower_bank(duration hold, float sps);
+                        basic_fast_ave_envelope_follower_bank(std::size_t hold_samples);
+
+      frame<N> const&   operator()(frame<N> const& s);
+
+      // Same accumulator as basic_moving_sum
+      using accumulator = decltype(promote(float()));
+
+      basic_fast_envelope_follower_bank<div, N> _fenv;
+      ring_buffer<frame<N>> _buff;
+      std::size_t _size;
+      std::array<accumulator, N> _sum;
+      frame<N> _y;
+   };
+
+   template <std::size_t N>
+   using fast_ave_envelope_follower_bank = basic_fast_ave_envelope_follower_bank<2, N>;
+
+   ////////////////////////////////////////////////////////////////////////////
+   // N channel fast_rms_envelope_follower
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   struct fast_rms_envelope_follower_bank
+    : detail::envelope_bank_base<fast_rms_envelope_follower_bank<N>, N>
+   {
+      constexpr static auto threshold = fast_rms_envelope_follower::threshold;
+
+      using base_type = detail::envelope_bank_base<fast_rms_envelope_follower_bank, N>;
+      using base_type::operator();
+
+                        fast_rms_envelope_follower_bank(duration hold, float sps);
+
+      frame<N> const&   operator()(frame<N> const& s);
+
+      fast_ave_envelope_follower_bank<N> _fenv;
+      frame<N> _y;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+
+   ////////////////////////////////////////////////////////////////////////////
+   // peak_envelope_follower_bank
+   template <std::size_t N>
+   inline peak_envelope_follower_bank<N>::peak_envelope_follower_bank(
+      duration release, float sps)
+    : _release(fast_exp3(-2.0f / (sps * as_double(release))))
+   {
+      _y.fill(0.0f);
+   }
+
+   template <std::size_t N>
+   inline frame<N> const&
+   peak_envelope_follower_bank<N>::operator()(frame<N> const& s)
+   {
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         auto decay = s[k] + _release * (_y[k] - s[k]);
+         _y[k] = (s[k] > _y[k])? s[k] : decay;
+      }
+      return _y;
+   }
+
+   template <std::size_t N>
+   inline peak_envelope_follower_bank<N>&
+   peak_envelope_follower_bank<N>::operator=(float y_)
+   {
+      _y.fill(y_);
+      return *this;
+   }
+
+   template <std::size_t N>
+   inline void peak_envelope_follower_bank<N>::release(duration release_, float sps)
+   {
+      _release = fast_exp3(-2.0f / (sps * as_double(release_)));
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // ar_envelope_follower_bank
+   template <std::size_t N>
+   inline ar_envelope_follower_bank<N>::ar_envelope_follower_bank(
+      duration attack, duration release, float sps)
+    : _attack(fast_exp3(-2.0f / (sps * as_double(attack))))
+    , _release(fast_exp3(-2.0f / (sps * as_double(release))))
+   {
+      _y.fill(0.0f);
+   }
+
+   template <std::size_t N>
+   inline frame<N> const&
+   ar_envelope_follower_bank<N>::operator()(frame<N> const& s)
+   {
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         auto coeff = (s[k] > _y[k])? _attack : _release;
+         _y[k] = s[k] + coeff * (_y[k] - s[k]);
+      }
+      return _y;
+   }
+
+   template <std::size_t N>
+   inline ar_envelope_follower_bank<N>&
+   ar_envelope_follower_bank<N>::operator=(float y_)
+   {
+      _y.fill(y_);
+      return *this;
+   }
+
+   template <std::size_t N>
+   inline void ar_envelope_follower_bank<N>::config(
+      duration attack, duration release, float sps)
+   {
+      _attack = fast_exp3(-2.0f / (sps * as_double(attack)));
+      _release = fast_exp3(-2.0f / (sps * as_double(release)));
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // basic_fast_envelope_follower_bank<div, N>
+   template <std::size_t div, std::size_t N>
+   inline basic_fast_envelope_follower_bank<div, N>::
+      basic_fast_envelope_follower_bank(duration hold, float sps)
+    : basic_fast_envelope_follower_bank(std::size_t(as_float(hold) * sps))
+   {}
+
+   template <std::size_t div, std::size_t N>
+   inline basic_fast_envelope_follower_bank<div, N>::
+      basic_fast_envelope_follower_bank(std::size_t hold_samples)
+    : _reset(hold_samples)
+   {
+      for (auto& step : _steps)
+         step.fill(0.0f);
+      _y.fill(0.0f);
+   }
+
+   template <std::size_t div, std::size_t N>
+   inline frame<N> const&
+   basic_fast_envelope_follower_bank<div, N>::operator()(frame<N> const& s)
+   {
+      // Update the steps
+      for (auto& step : _steps)
+         for (std::size_t k = 0; k != N; ++k)
+            step[k] = std::max(s[k], step[k]);
+
+      // Reset the steps in a round-robin fashion every so often (the hold
+      // parameter)
+      if (_tick++ == _reset)
+      {
+         _tick = 0;
+         _steps[_i++ % size].fill(0.0f);
+      }
+
+      // The peak is the maximum of the steps
+      _y = _steps[0];
+      for (std::size_t j = 1; j != size; ++j)
+         for (std::size_t k = 0; k != N; ++k)
+            _y[k] = std::max(_steps[j][k], _y[k]);
+      return _y;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // basic_fast_ave_envelope_follower_bank<div, N>
+   template <std::size_t div, std::size_t N>
+   inline basic_fast_ave_envelope_follower_bank<div, N>::
+      basic_fast_ave_envelope_follower_bank(duration hold, float sps)
+    : basic_fast_ave_envelope_follower_bank(std::size_t(as_float(hold) * sps))
+   {}
+
+   template <std::size_t div, std::size_t N>
+   inline basic_fast_ave_envelope_follower_bank<div, N>::
+      basic_fast_ave_envelope_follower_bank(std::size_t hold_samples)
+    : _fenv(hold_samples)
+    , _buff(hold_samples)
+    , _size(hold_samples)
+   {
+      _buff.clear();
+      _sum.fill(0);
+      _y.fill(0.0f);
+   }
+
+   template <std::size_t div, std::size_t N>
+   inline frame<N> const&
+   basic_fast_ave_envelope_follower_bank<div, N>::operator()(frame<N> const& s)
+   {
+      auto const& e = _fenv(s);
+      auto const& oldest = _buff[_size-1];
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         _sum[k] += e[k];
+         _sum[k] -= oldest[k];
+         _y[k] = _sum[k] / _size;
+      }
+      _buff.push(e);
+      return _y;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // fast_rms_envelope_follower_bank<N>
+   template <std::size_t N>
+   inline fast_rms_envelope_follower_bank<N>::fast_rms_envelope_follower_bank(
+      duration hold, float sps)
+    : _fenv(hold, sps)
+   {
+      _y.fill(0.0f);
+   }
+
+   template <std::size_t N>
+   inline frame<N> const&
+   fast_rms_envelope_follower_bank<N>::operator()(frame<N> const& s)
+   {
+      frame<N> sq;
+      for (std::size_t k = 0; k != N; ++k)
+         sq[k] = s[k] * s[k];
+      auto const& e = _fenv(sq);
+      for (std::size_t k = 0; k != N; ++k)
+         _y[k] = (e[k] < threshold)? 0.0f : fast_sqrt(e[k]);
+      return _y;
+   }
+}
+
+#endif
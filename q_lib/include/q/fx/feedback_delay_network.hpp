@@ -0,0 +1,213 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_FEEDBACK_DELAY_NETWORK_OCTOBER_19_2026)
+#define CYCFI_Q_FEEDBACK_DELAY_NETWORK_OCTOBER_19_2026
+
+#include <q/support/literals.hpp>
+#include <q/utility/ring_buffer.hpp>
+#include <q/fx/lowpass.hpp>
+#include <array>
+#include <cmath>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Feedback matrices for the feedback_delay_network. Both are orthogonal
+   // (lossless) and need no matrix multiplication:
+   //
+   // householder_matrix: A = I - (2/N) * 1 * 1^T. Costs O(N).
+   //
+   // hadamard_matrix: Sylvester's Hadamard matrix, scaled by 1/sqrt(N),
+   // computed using the fast Walsh-Hadamard transform. Costs O(N log2(N)).
+   // N must be a power of 2. Hadamard has denser mixing than Householder.
+   ////////////////////////////////////////////////////////////////////////////
+   struct householder_matrix
+   {
+      template <std::size_t N>
+      void operator()(std::array<float, N>& x) const
+      {
+         float sum = 0.0f;
+         for (auto e : x)
+            sum += e;
+         sum *= 2.0f / N;
+         for (auto& e : x)
+            e -= sum;
+      }
+   };
+
+   struct hadamard_matrix
+   {
+      template <std::size_t N>
+      void operator()(std::array<float, N>& x) const
+      {
+         static_assert(is_pow2(N), "Error: N must be a power of two");
+         for (std::size_t h = 1; h < N; h *= 2)
+         {
+            for (std::size_t i = 0; i < N; i += h * 2)
+            {
+               for (std::size_t j = i; j < i + h; ++j)
+               {
+                  auto a = x[j];
+                  auto b = x[j + h];
+                  x[j] = a + b;
+                  x[j + h] = a - b;
+               }
+            }
+         }
+         float const scale = 1.0f / std::sqrt(float(N));
+         for (auto& e : x)
+            e *= scale;
+      }
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // feedback_delay_network: N delay lines whose outputs are mixed by an
+   // orthogonal feedback matrix and fed back to their inputs. This is the
+   // core of a Jot-style reverb.
+   //
+   // The delay line lengths (in samples) are supplied at construction. A
+   // length of 0 is clamped to 1 (the minimum delay of a feedback loop).
+   // Mutually prime lengths give the densest echoes. decay(t60, sps) sets
+   // the per-line feedback gains so that all lines decay by 60dB in t60.
+   // damping(f, sps) sets the cutoff of the one pole lowpass filter in each
+   // feedback path (high frequencies decay faster). By default, there is no
+   // damping. There is no feedback until decay(t60, sps) is called: the
+   // network is then a plain multi-tap delay (each input sample comes out
+   // once per line).
+   //
+   // All line outputs are read in one pass. The function call operator
+   // returns the sum of the line outputs; the individual (decorrelated)
+   // line outputs are available via outputs(), e.g. to derive multiple
+   // output channels.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N, typename Matrix = householder_matrix>
+   class feedback_delay_network
+   {
+   public:
+
+      using lines_type = std::array<float, N>;
+
+                        feedback_delay_network(
+                           std::array<std::size_t, N> const& lengths
+                        );
+
+      float             operator()(float s);
+      float             operator()() const;
+      lines_type const& outputs() const;
+
+      void              decay(duration t60, float sps);
+      void              damping(frequency f, float sps);
+      void              clear();
+
+   private:
+
+      std::array<ring_buffer<float>, N>   _lines;
+      std::array<std::size_t, N>          _lengths;
+      std::array<float, N>                _gains;
+      std::array<one_pole_lowpass, N>     _damping;
+      lines_type                          _out;
+      float                               _y = 0.0f;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   namespace detail
+   {
+      template <std::size_t... I>
+      inline std::array<ring_buffer<float>, sizeof...(I)>
+      make_lines(std::size_t const* lengths, std::index_sequence<I...>)
+      {
+         return { ring_buffer<float>(std::max<std::size_t>(lengths[I], 1))... };
+      }
+
+      template <std::size_t... I>
+      inline std::array<one_pole_lowpass, sizeof...(I)>
+      make_damping(std::index_sequence<I...>)
+      {
+         return { one_pole_lowpass((void(I), 1.0f))... };
+      }
+   }
+
+   template <std::size_t N, typename Matrix>
+   inline feedback_delay_network<N, Matrix>::feedback_delay_network(
+      std::array<std::size_t, N> const& lengths
+   )
+    : _lines(detail::make_lines(lengths.data(), std::make_index_sequence<N>{}))
+    , _lengths(lengths)
+    , _damping(detail::make_damping(std::make_index_sequence<N>{}))
+   {
+      // A length of 0 is clamped to 1
+      for (auto& length : _lengths)
+         length = std::max<std::size_t>(length, 1);
+      _gains.fill(0.0f);
+      _out.fill(0.0f);
+      for (auto& line : _lines)
+         line.clear();
+   }
+
+   template <std::size_t N, typename Matrix>
+   inline float feedback_delay_network<N, Matrix>::operator()(float s)
+   {
+      // Read all the line outputs
+      for (std::size_t i = 0; i != N; ++i)
+         _out[i] = _lines[i][_lengths[i] - 1];
+
+      float y = 0.0f;
+      for (auto e : _out)
+         y += e;
+
+      // Mix and feed back
+      lines_type fb = _out;
+      Matrix{}(fb);
+      for (std::size_t i = 0; i != N; ++i)
+         _lines[i].push(s + _damping[i](_gains[i] * fb[i]));
+
+      return _y = y;
+   }
+
+   template <std::size_t N, typename Matrix>
+   inline float feedback_delay_network<N, Matrix>::operator()() const
+   {
+      return _y;
+   }
+
+   template <std::size_t N, typename Matrix>
+   inline typename feedback_delay_network<N, Matrix>::lines_type const&
+   feedback_delay_network<N, Matrix>::outputs() const
+   {
+      return _out;
+   }
+
+   template <std::size_t N, typename Matrix>
+   inline void feedback_delay_network<N, Matrix>::decay(duration t60, float sps)
+   {
+      // -60dB after t60: g^(t60 * sps / length) = 0.001
+      auto const samples = as_double(t60) * sps;
+      for (std::size_t i = 0; i != N; ++i)
+         _gains[i] = std::pow(0.001, _lengths[i] / samples);
+   }
+
+   template <std::size_t N, typename Matrix>
+   inline void feedback_delay_network<N, Matrix>::damping(frequency f, float sps)
+   {
+      for (auto& lp : _damping)
+         lp.cutoff(f, sps);
+   }
+
+   template <std::size_t N, typename Matrix>
+   inline void feedback_delay_network<N, Matrix>::clear()
+   {
+      for (auto& line : _lines)
+         line.clear();
+      for (auto& lp : _damping)
+         lp = 0.0f;
+      _out.fill(0.0f);
+      _y = 0.0f;
+   }
+}
+
+#endif
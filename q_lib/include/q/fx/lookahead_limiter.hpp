@@ -0,0 +1,290 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_LOOKAHEAD_LIMITER_OCTOBER_19_2026)
+#define CYCFI_Q_LOOKAHEAD_LIMITER_OCTOBER_19_2026
+
+#include <q/support/base.hpp>
+#include <q/support/literals.hpp>
+#include <q/support/decibel.hpp>
+#include <q/fx/delay.hpp>
+#include <q/fx/moving_maximum.hpp>
+#include <q/fx/moving_average.hpp>
+#include <array>
+#include <algorithm>
+#include <cmath>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // basic_lookahead_limiter: a look-ahead brickwall limiter for N linked
+   // channels. The output never exceeds the ceiling.
+   //
+   // The signal path is delayed (nf_delay) by the lookahead duration, L
+   // samples. The detector path computes the peak of all channels, takes
+   // the sliding maximum over L+1 samples (block_moving_maximum) and
+   // computes the gain required to bring that maximum down to the ceiling.
+   // The gain is released with an exponential decay (but attacks
+   // instantly), then smoothed using a moving average over L+1 samples.
+   // Because each gain sample in the moving average window is computed
+   // from a maximum window that covers the delayed sample, the smoothed
+   // gain is never more than the gain required by the delayed sample, so
+   // the gain ramps down smoothly, ahead of the peaks, without overshoot.
+   //
+   // With true_peak=true, the detector estimates the inter-sample peaks
+   // using 4x oversampling (a polyphase windowed-sinc interpolator with 8
+   // taps per phase), similar to the true-peak meters of ITU-R BS.1770.
+   // This adds 4 samples to the latency.
+   //
+   // The limiter is block processed. All buffers are allocated at
+   // construction. process(in, out, n) takes N input channels and N output
+   // channels. In-place processing (in == out) is allowed.
+   //
+   // lookahead_limiter (mono) and stereo_lookahead_limiter are provided.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   class basic_lookahead_limiter
+   {
+   public:
+
+      using in_channels = std::array<float const*, N>;
+      using out_channels = std::array<float*, N>;
+
+      static constexpr std::size_t true_peak_latency = 4;
+
+                  basic_lookahead_limiter(
+                     duration lookahead
+                   , duration release
+                   , float sps
+                   , decibel ceiling = 0_dB
+                   , bool true_peak = false
+                  );
+
+      void        process(in_channels const& in, out_channels const& out, std::size_t n);
+      void        process(float const* in, float* out, std::size_t n);
+
+      void        ceiling(decibel val);
+      decibel     ceiling() const;
+      void        release(duration release_, float sps);
+      std::size_t latency() const;
+      decibel     gain() const;
+      void        clear();
+
+   private:
+
+      static constexpr std::size_t chunk_size = 64;
+      static constexpr std::size_t taps = 8;
+
+      float       peak(std::size_t ch, float s);
+      void        true_peak_coefficients();
+
+      using history = std::array<float, taps>;
+      using phases = std::array<std::array<float, taps>, 3>;
+
+      std::size_t                   _lookahead;
+      bool                          _true_peak;
+      float                         _ceiling;
+      float                         _release;
+      float                         _gain = 1.0f;     // released gain
+      float                         _out_gain = 1.0f; // smoothed gain
+      std::array<nf_delay, N>       _delay;
+      block_moving_maximum<float>   _max;
+      basic_moving_average<float, true> _smooth;
+      std::array<history, N>        _history;
+      phases                        _phases;
+   };
+
+   using lookahead_limiter = basic_lookahead_limiter<1>;
+   using stereo_lookahead_limiter = basic_lookahead_limiter<2>;
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   namespace detail
+   {
+      template <std::size_t... I>
+      inline std::array<nf_delay, sizeof...(I)>
+      make_delays(std::size_t size, std::index_sequence<I...>)
+      {
+         return { nf_delay((void(I), size))... };
+      }
+   }
+
+   template <std::size_t N>
+   inline basic_lookahead_limiter<N>::basic_lookahead_limiter(
+      duration lookahead
+    , duration release
+    , float sps
+    , decibel ceiling
+    , bool true_peak
+   )
+    : _lookahead(std::max<std::size_t>(std::size_t(as_double(lookahead) * sps), 1))
+    , _true_peak(true_peak)
+    , _ceiling(as_float(ceiling))
+    , _release(fast_exp3(-2.0f / (sps * as_double(release))))
+    , _delay(detail::make_delays(latency() + 1, std::make_index_sequence<N>{}))
+    , _max(_lookahead + 1)
+    , _smooth(_lookahead + 1)
+   {
+      true_peak_coefficients();
+      clear();
+   }
+
+   // Compute the 4x oversampling interpolator phases at 1/4, 2/4 and 3/4
+   // (phase 0 is the sample itself), using a Hann windowed sinc.
+   template <std::size_t N>
+   inline void basic_lookahead_limiter<N>::true_peak_coefficients()
+   {
+      constexpr auto half_width = taps / 2 + 0.5;
+      for (std::size_t p = 0; p != 3; ++p)
+      {
+         auto const frac = (p + 1) / 4.0;
+         double sum = 0;
+         for (std::size_t j = 0; j != taps; ++j)
+         {
+            // Distance from the interpolated point (between history[3]
+            // and history[4]) to history[j]
+            auto x = (taps / 2 - 1 + frac) - j;
+            auto sinc = std::sin(pi * x) / (pi * x);
+            auto window = 0.5 + 0.5 * std::cos(pi * x / half_width);
+            _phases[p][j] = sinc * window;
+            sum += _phases[p][j];
+         }
+         for (auto& c : _phases[p])
+            c /= sum;
+      }
+   }
+
+   // Detector: the absolute peak of the latest sample, or with true peak
+   // detection, the maximum of the absolute sample and the 3 interpolated
+   // points following it, delayed by true_peak_latency.
+   template <std::size_t N>
+   inline float basic_lookahead_limiter<N>::peak(std::size_t ch, float s)
+   {
+      if (!_true_peak)
+         return std::abs(s);
+
+      auto& h = _history[ch];
+      std::copy(h.begin() + 1, h.end(), h.begin());
+      h[taps-1] = s;
+
+      auto r = std::abs(h[taps/2 - 1]);
+      for (auto const& phase : _phases)
+      {
+         float y = 0.0f;
+         for (std::size_t j = 0; j != taps; ++j)
+            y += phase[j] * h[j];
+         r = std::max(r, std::abs(y));
+      }
+      return r;
+   }
+
+   template <std::size_t N>
+   inline void basic_lookahead_limiter<N>::process(
+      in_channels const& in, out_channels const& out, std::size_t n)
+   {
+      float peaks[chunk_size];
+      float maxima[chunk_size];
+      float gains[chunk_size];
+      auto const delay_index = latency() - 1;
+
+      for (std::size_t i = 0; i < n; i += chunk_size)
+      {
+         auto const m = std::min(n - i, chunk_size);
+
+         // Detect the peak of all channels
+         for (std::size_t j = 0; j != m; ++j)
+         {
+            float p = 0.0f;
+            for (std::size_t ch = 0; ch != N; ++ch)
+               p = std::max(p, peak(ch, in[ch][i+j]));
+            peaks[j] = p;
+         }
+
+         // Sliding maximum of the peaks
+         _max.process(peaks, maxima, m);
+
+         // Required gain, with instant attack and exponential release
+         auto g = _gain;
+         for (std::size_t j = 0; j != m; ++j)
+         {
+            auto req = (maxima[j] > _ceiling)? _ceiling / maxima[j] : 1.0f;
+            g = (req < g)? req : req + _release * (g - req);
+            peaks[j] = g;
+         }
+         _gain = g;
+
+         // Smooth the gain
+         _smooth.process(peaks, gains, m);
+
+         // Apply the gain to the delayed signal. The final clamp only
+         // absorbs floating point round-off.
+         for (std::size_t ch = 0; ch != N; ++ch)
+         {
+            auto& d = _delay[ch];
+            for (std::size_t j = 0; j != m; ++j)
+            {
+               auto y = d(in[ch][i+j], delay_index) * gains[j];
+               out[ch][i+j] = std::clamp(y, -_ceiling, _ceiling);
+            }
+         }
+         _out_gain = gains[m-1];
+      }
+   }
+
+   template <std::size_t N>
+   inline void basic_lookahead_limiter<N>::process(
+      float const* in, float* out, std::size_t n)
+   {
+      static_assert(N == 1, "Error: Use process(in_channels, out_channels, n)");
+      process(in_channels{ in }, out_channels{ out }, n);
+   }
+
+   template <std::size_t N>
+   inline void basic_lookahead_limiter<N>::ceiling(decibel val)
+   {
+      _ceiling = as_float(val);
+   }
+
+   template <std::size_t N>
+   inline decibel basic_lookahead_limiter<N>::ceiling() const
+   {
+      return decibel(_ceiling);
+   }
+
+   template <std::size_t N>
+   inline void basic_lookahead_limiter<N>::release(duration release_, float sps)
+   {
+      _release = fast_exp3(-2.0f / (sps * as_double(release_)));
+   }
+
+   // Get the latency (in samples) of the signal path.
+   template <std::size_t N>
+   inline std::size_t basic_lookahead_limiter<N>::latency() const
+   {
+      return _lookahead + (_true_peak? true_peak_latency : 0);
+   }
+
+   // Get the latest applied gain (for gain reduction metering).
+   template <std::size_t N>
+   inline decibel basic_lookahead_limiter<N>::gain() const
+   {
+      return decibel(_out_gain);
+   }
+
+   template <std::size_t N>
+   inline void basic_lookahead_limiter<N>::clear()
+   {
+      for (auto& d : _delay)
+         d.clear();
+      for (auto& h : _history)
+         h.fill(0.0f);
+      _max.clear();
+      _smooth.fill(1.0f);
+      _gain = _out_gain = 1.0f;
+   }
+}
+
+#endif
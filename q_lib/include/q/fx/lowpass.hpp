@@ -202,6 +202,24 @@ namespace cycfi::q
       float _y0 = 0, _y1 = 0;
    };
 
+   namespace detail
+   {
+      // The dynamic_smoother update, shared by dynamic_smoother and
+      // dynamic_smoother_bank. Updates low1 and low2 and returns the
+      // previous low2.
+      inline float dynamic_smoother_step(
+         float s, float g0, float sense, float& low1, float& low2)
+      {
+         auto low1z = low1;
+         auto low2z = low2;
+         auto bandz = low1z - low2z;
+         auto g = std::min(g0 + sense * std::abs(bandz), 1.0f);
+         low1 = low1z + g * (s - low1z);
+         low2 = low2z + g * (low1 - low2z);
+         return low2z;
+      }
+   }
+
    ////////////////////////////////////////////////////////////////////////////
    // dynamic_smoother based on Dynamic Smoothing Using Self Modulating Filter
    // by Andrew Simper, Cytomic, 2014, andy@cytomic.com
@@ -231,15 +249,36 @@ namespace cycfi::q
          g0 = 2.0f * gc / (1.0f + gc);
       }
 
+      // The filter state, for processing with the state kept in local
+      // variables (registers), using step.
+      struct state
+      {
+         float low1, low2;
+      };
+
+      state get_state() const
+      {
+         return { low1, low2 };
+      }
+
+      void set_state(state const& st)
+      {
+         low1 = st.low1;
+         low2 = st.low2;
+      }
+
+      // Process one sample, given the state, and update the state
+      float step(float s, state& st) const
+      {
+         return detail::dynamic_smoother_step(s, g0, sense, st.low1, st.low2);
+      }
+
       float operator()(float s)
       {
-         auto lowlz = low1;
-         auto low2z = low2;
-         auto bandz = lowlz - low2z;
-         auto g = std::min(g0 + sense * std::abs(bandz), 1.0f);
-         low1 = lowlz + g * (s - lowlz);
-         low2 = low2z + g * (low1 - low2z);
-         return low2z;
+         auto st = get_state();
+         auto r = step(s, st);
+         set_state(st);
+         return r;
       }
 
       void base_frequency(frequency base, float sps)
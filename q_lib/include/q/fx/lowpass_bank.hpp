@@ -0,0 +1,280 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_LOWPASS_BANK_OCTOBER_19_2026)
+#define CYCFI_Q_LOWPASS_BANK_OCTOBER_19_2026
+
+#include <q/fx/lowpass.hpp>
+#include <q/detail/bank_base.hpp>
+#include <cmath>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Multichannel leaky_integrator, one_pole_lowpass and dynamic_smoother,
+   // e.g. for smoothing many control signals (envelopes, MIDI CCs,
+   // parameter ramps) at once.
+   //
+   // The state and coefficients are kept in SoA (structure of arrays)
+   // layout: one array of N lanes per variable, so that each lane may have
+   // its own coefficients. The per-sample function call operator takes and
+   // returns a frame (std::array<float, N>), and all lanes are updated in
+   // branch-free loops that the compiler can vectorize (e.g. 8 lanes per
+   // AVX instruction, 16 lanes per AVX-512 instruction). The input frame is
+   // copied first so the compiler need not check for aliasing with the
+   // state. Choose N to be a multiple of the SIMD width.
+   //
+   // The coefficient setters come in two flavors: one that sets all lanes
+   // and one that sets lane k only.
+   //
+   // Block processing is available via process(in, out, n), given N input
+   // channels and N output channels.
+   ////////////////////////////////////////////////////////////////////////////
+
+   ////////////////////////////////////////////////////////////////////////////
+   // N channel leaky_integrator
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   struct leaky_integrator_bank
+    : detail::bank_base<leaky_integrator_bank<N>, N>
+   {
+      using base_type = detail::bank_base<leaky_integrator_bank<N>, N>;
+      using base_type::operator();
+
+                              leaky_integrator_bank(float a_ = 0.995);
+                              leaky_integrator_bank(frequency f, float sps);
+
+      frame<N> const&         operator()(frame<N> const& s);
+      leaky_integrator_bank&  operator=(float y_);
+
+      void                    cutoff(frequency f, float sps);
+      void                    cutoff(std::size_t k, frequency f, float sps);
+
+      frame<N> _y, _a;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // N channel one_pole_lowpass
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   struct one_pole_lowpass_bank
+    : detail::bank_base<one_pole_lowpass_bank<N>, N>
+   {
+      using base_type = detail::bank_base<one_pole_lowpass_bank<N>, N>;
+      using base_type::operator();
+
+                              one_pole_lowpass_bank(float a_);
+                              one_pole_lowpass_bank(frequency freq, float sps);
+
+      frame<N> const&         operator()(frame<N> const& s);
+      one_pole_lowpass_bank&  operator=(float y_);
+
+      void                    cutoff(frequency freq, float sps);
+      void                    cutoff(std::size_t k, frequency freq, float sps);
+
+      frame<N> _y, _a;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // N channel dynamic_smoother
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   struct dynamic_smoother_bank
+    : detail::bank_base<dynamic_smoother_bank<N>, N>
+   {
+      using base_type = detail::bank_base<dynamic_smoother_bank<N>, N>;
+      using base_type::operator();
+
+                              dynamic_smoother_bank(frequency base, float sps);
+                              dynamic_smoother_bank(frequency base, float sensitivity, float sps);
+
+      frame<N> const&         operator()(frame<N> const& s);
+      dynamic_smoother_bank&  operator=(float y_);
+
+      void                    base_frequency(frequency base, float sps);
+      void                    base_frequency(std::size_t k, frequency base, float sps);
+      void                    sensitivity(float sensitivity_);
+      void                    sensitivity(std::size_t k, float sensitivity_);
+
+      frame<N> _sense, _g0;
+      frame<N> _low1, _low2;
+      frame<N> _y;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+
+   ////////////////////////////////////////////////////////////////////////////
+   // leaky_integrator_bank
+   template <std::size_t N>
+   inline leaky_integrator_bank<N>::leaky_integrator_bank(float a_)
+   {
+      _y.fill(0.0f);
+      _a.fill(a_);
+   }
+
+   template <std::size_t N>
+   inline leaky_integrator_bank<N>::leaky_integrator_bank(frequency f, float sps)
+   {
+      _y.fill(0.0f);
+      cutoff(f, sps);
+   }
+
+   template <std::size_t N>
+   inline frame<N> const&
+   leaky_integrator_bank<N>::operator()(frame<N> const& s_)
+   {
+      auto const s = s_; // no aliasing with the state
+      for (std::size_t k = 0; k != N; ++k)
+         _y[k] = s[k] + _a[k] * (_y[k] - s[k]);
+      return _y;
+   }
+
+   template <std::size_t N>
+   inline leaky_integrator_bank<N>&
+   leaky_integrator_bank<N>::operator=(float y_)
+   {
+      _y.fill(y_);
+      return *this;
+   }
+
+   template <std::size_t N>
+   inline void leaky_integrator_bank<N>::cutoff(frequency f, float sps)
+   {
+      _a.fill(1.0f -(2_pi * as_double(f) / sps));
+   }
+
+   template <std::size_t N>
+   inline void leaky_integrator_bank<N>::cutoff(
+      std::size_t k, frequency f, float sps)
+   {
+      _a[k] = 1.0f -(2_pi * as_double(f) / sps);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // one_pole_lowpass_bank
+   template <std::size_t N>
+   inline one_pole_lowpass_bank<N>::one_pole_lowpass_bank(float a_)
+   {
+      _y.fill(0.0f);
+      _a.fill(a_);
+   }
+
+   template <std::size_t N>
+   inline one_pole_lowpass_bank<N>::one_pole_lowpass_bank(
+      frequency freq, float sps)
+   {
+      _y.fill(0.0f);
+      cutoff(freq, sps);
+   }
+
+   template <std::size_t N>
+   inline frame<N> const&
+   one_pole_lowpass_bank<N>::operator()(frame<N> const& s_)
+   {
+      auto const s = s_; // no aliasing with the state
+      for (std::size_t k = 0; k != N; ++k)
+         _y[k] += _a[k] * (s[k] - _y[k]);
+      return _y;
+   }
+
+   template <std::size_t N>
+   inline one_pole_lowpass_bank<N>&
+   one_pole_lowpass_bank<N>::operator=(float y_)
+   {
+      _y.fill(y_);
+      return *this;
+   }
+
+   template <std::size_t N>
+   inline void one_pole_lowpass_bank<N>::cutoff(frequency freq, float sps)
+   {
+      _a.fill(1.0 - fast_exp3(-2_pi * as_double(freq) / sps));
+   }
+
+   template <std::size_t N>
+   inline void one_pole_lowpass_bank<N>::cutoff(
+      std::size_t k, frequency freq, float sps)
+   {
+      _a[k] = 1.0 - fast_exp3(-2_pi * as_double(freq) / sps);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // dynamic_smoother_bank
+   template <std::size_t N>
+   inline dynamic_smoother_bank<N>::dynamic_smoother_bank(
+      frequency base, float sps)
+    : dynamic_smoother_bank(base, 0.5, sps)
+   {}
+
+   template <std::size_t N>
+   inline dynamic_smoother_bank<N>::dynamic_smoother_bank(
+      frequency base, float sensitivity_, float sps)
+   {
+      sensitivity(sensitivity_);
+      base_frequency(base, sps);
+      _low1.fill(0.0f);
+      _low2.fill(0.0f);
+      _y.fill(0.0f);
+   }
+
+   template <std::size_t N>
+   inline frame<N> const&
+   dynamic_smoother_bank<N>::operator()(frame<N> const& s_)
+   {
+      auto const s = s_; // no aliasing with the state
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         _y[k] = detail::dynamic_smoother_step(
+            s[k], _g0[k], _sense[k], _low1[k], _low2[k]);
+      }
+      return _y;
+   }
+
+   template <std::size_t N>
+   inline dynamic_smoother_bank<N>&
+   dynamic_smoother_bank<N>::operator=(float y_)
+   {
+      _low1.fill(y_);
+      _low2.fill(y_);
+      _y.fill(y_);
+      return *this;
+   }
+
+   template <std::size_t N>
+   inline void dynamic_smoother_bank<N>::base_frequency(
+      frequency base, float sps)
+   {
+      float wc = as_double(base) / sps;
+      auto gc = std::tan(pi * wc);
+      _g0.fill(2.0f * gc / (1.0f + gc));
+   }
+
+   template <std::size_t N>
+   inline void dynamic_smoother_bank<N>::base_frequency(
+      std::size_t k, frequency base, float sps)
+   {
+      float wc = as_double(base) / sps;
+      auto gc = std::tan(pi * wc);
+      _g0[k] = 2.0f * gc / (1.0f + gc);
+   }
+
+   // The sensitivity is from 0.0 to 1.0 (see dynamic_smoother)
+   template <std::size_t N>
+   inline void dynamic_smoother_bank<N>::sensitivity(float sensitivity_)
+   {
+      _sense.fill(sensitivity_ * 4.0f);   // efficient linear cutoff mapping
+   }
+
+   template <std::size_t N>
+   inline void dynamic_smoother_bank<N>::sensitivity(
+      std::size_t k, float sensitivity_)
+   {
+      _sense[k] = sensitivity_ * 4.0f;
+   }
+}
+
+#endif
@@ -7,6 +7,9 @@
 #define CYCFI_Q_MEDIAN_DECEMBER_7_2018
 
 #include <q/support/base.hpp>
+#include <q/support/literals.hpp>
+#include <array>
+#include <vector>
 
 namespace cycfi::q
 {
@@ -54,6 +57,325 @@ namespace cycfi::q
       float b = 0.0f;
       float c = 0.0f;
    };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Median of 5, 7 and 9 points using optimal median selection networks
+   // (compare-exchange sequences). These are branch-free: each
+   // compare-exchange is a min and a max.
+   //
+   // Source: N. Devillard, "Fast median search: an ANSI C implementation",
+   // 1998 (based on Paeth's and Smith's median networks).
+   ////////////////////////////////////////////////////////////////////////////
+   namespace detail
+   {
+      inline void sort2(float& a, float& b)
+      {
+         auto lo = std::min(a, b);
+         b = std::max(a, b);
+         a = lo;
+      }
+   }
+
+   inline float median5f(std::array<float, 5> p)
+   {
+      using detail::sort2;
+      sort2(p[0], p[1]); sort2(p[3], p[4]); sort2(p[0], p[3]);
+      sort2(p[1], p[4]); sort2(p[1], p[2]); sort2(p[2], p[3]);
+      sort2(p[1], p[2]);
+      return p[2];
+   }
+
+   inline float median7f(std::array<float, 7> p)
+   {
+      using detail::sort2;
+      sort2(p[0], p[5]); sort2(p[0], p[3]); sort2(p[1], p[6]);
+      sort2(p[2], p[4]); sort2(p[0], p[1]); sort2(p[3], p[5]);
+      sort2(p[2], p[6]); sort2(p[2], p[3]); sort2(p[3], p[6]);
+      sort2(p[4], p[5]); sort2(p[1], p[4]); sort2(p[1], p[3]);
+      sort2(p[3], p[4]);
+      return p[3];
+   }
+
+   inline float median9f(std::array<float, 9> p)
+   {
+      using detail::sort2;
+      sort2(p[1], p[2]); sort2(p[4], p[5]); sort2(p[7], p[8]);
+      sort2(p[0], p[1]); sort2(p[3], p[4]); sort2(p[6], p[7]);
+      sort2(p[1], p[2]); sort2(p[4], p[5]); sort2(p[7], p[8]);
+      sort2(p[0], p[3]); sort2(p[5], p[8]); sort2(p[4], p[7]);
+      sort2(p[3], p[6]); sort2(p[1], p[4]); sort2(p[2], p[5]);
+      sort2(p[4], p[7]); sort2(p[4], p[2]); sort2(p[6], p[4]);
+      sort2(p[4], p[2]);
+      return p[4];
+   }
+
+   namespace detail
+   {
+      inline float median_of(std::array<float, 5> const& p) { return median5f(p); }
+      inline float median_of(std::array<float, 7> const& p) { return median7f(p); }
+      inline float median_of(std::array<float, 9> const& p) { return median9f(p); }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // N-point 1D median filter (N = 5, 7 or 9). Returns the median of the N
+   // latest samples. Like median3, this is intended for the per-sample hot
+   // path. The cost is a fixed number of branch-free compare-exchanges per
+   // sample. For wider windows, use moving_median or moving_quantile.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   struct basic_median
+   {
+      static_assert(N == 5 || N == 7 || N == 9, "N must be 5, 7 or 9");
+
+      basic_median(float median_ = 0.0f)
+      {
+         *this = median_;
+      }
+
+      float operator()(float a)
+      {
+         _x[_i] = a;
+         if (++_i == N)
+            _i = 0;
+         return _median = detail::median_of(_x);
+      }
+
+      float operator()() const
+      {
+         return _median;
+      }
+
+      basic_median& operator=(float median_)
+      {
+         _x.fill(median_);
+         _median = median_;
+         return *this;
+      }
+
+      std::array<float, N> _x;
+      std::size_t _i = 0;
+      float _median = 0.0f;
+   };
+
+   using median5 = basic_median<5>;
+   using median7 = basic_median<7>;
+   using median9 = basic_median<9>;
+
+   ////////////////////////////////////////////////////////////////////////////
+   // moving_quantile: a sliding window quantile (percentile) filter with an
+   // O(log2(L)) update cost per sample, where L is the window size.
+   //
+   // The window is kept in two indexed binary heaps: a max-heap holding the
+   // lowest k+1 samples (its root is the k-th smallest sample, the
+   // quantile) and a min-heap holding the rest. Each ring buffer slot knows
+   // its location in the heaps, so the oldest sample is replaced in place by
+   // the latest, then sifted within its heap. At most one exchange of the
+   // heap roots rebalances the two heaps.
+   //
+   // The quantile parameter, q (0 to 1), selects the nearest rank
+   // k = round(q * (L-1)). q = 0.5 gives the median, q = 0 the minimum and
+   // q = 1 the maximum. q is clamped to [0, 1]. The window is initially
+   // filled with the supplied initial value.
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T = float>
+   class moving_quantile
+   {
+   public:
+                     moving_quantile(
+                        std::size_t size, float q = 0.5f, T init = T{});
+                     moving_quantile(
+                        duration d, float sps, float q = 0.5f, T init = T{});
+
+      T              operator()(T s);
+      T              operator()() const;
+      std::size_t    size() const;
+      void           fill(T val);
+
+   private:
+
+      // Heap entries are ring buffer slots. _where[slot] is the index of
+      // the slot in its heap. Slots in the low (max) heap have _in_low set.
+      using heap = std::vector<std::size_t>;
+
+      void           swap_entries(heap& h, std::size_t i, std::size_t j);
+      template <typename Compare>
+      void           sift_up(heap& h, std::size_t i, Compare comp);
+      template <typename Compare>
+      void           sift_down(heap& h, std::size_t i, Compare comp);
+
+      bool           greater(std::size_t a, std::size_t b) const;
+      bool           less(std::size_t a, std::size_t b) const;
+
+      std::vector<T>    _data;
+      std::vector<std::size_t> _where;
+      std::vector<bool> _in_low;
+      heap              _low;    // max-heap: the lowest k+1 samples
+      heap              _high;   // min-heap: the rest
+      std::size_t       _i = 0;  // oldest slot
+   };
+
+   template <typename T = float>
+   struct moving_median : moving_quantile<T>
+   {
+      moving_median(std::size_t size, T init = T{})
+       : moving_quantile<T>(size, 0.5f, init)
+      {}
+
+      moving_median(duration d, float sps, T init = T{})
+       : moving_quantile<T>(d, sps, 0.5f, init)
+      {}
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T>
+   inline moving_quantile<T>::moving_quantile(std::size_t size, float q, T init)
+    : _data(std::max<std::size_t>(size, 1))
+    , _where(_data.size())
+    , _in_low(_data.size())
+   {
+      // A size of 0 (e.g. from a very short duration) is clamped to 1, and
+      // q is clamped to [0, 1]
+      size = _data.size();
+      q = (q > 0.0f)? std::min(q, 1.0f) : 0.0f;
+      auto const k = std::min<std::size_t>(q * (size - 1) + 0.5f, size - 1);
+      _low.reserve(k + 1);
+      _high.reserve(size - (k + 1));
+      for (std::size_t slot = 0; slot != size; ++slot)
+      {
+         auto& h = (slot <= k)? _low : _high;
+         _in_low[slot] = (slot <= k);
+         _where[slot] = h.size();
+         h.push_back(slot);
+      }
+      fill(init);
+   }
+
+   template <typename T>
+   inline moving_quantile<T>::moving_quantile(
+      duration d, float sps, float q, T init)
+    : moving_quantile(std::size_t(sps * as_float(d)), q, init)
+   {}
+
+   template <typename T>
+   inline bool moving_quantile<T>::greater(std::size_t a, std::size_t b) const
+   {
+      return _data[a] > _data[b];
+   }
+
+   template <typename T>
+   inline bool moving_quantile<T>::less(std::size_t a, std::size_t b) const
+   {
+      return _data[a] < _data[b];
+   }
+
+   template <typename T>
+   inline void moving_quantile<T>::swap_entries(
+      heap& h, std::size_t i, std::size_t j)
+   {
+      std::swap(h[i], h[j]);
+      _where[h[i]] = i;
+      _where[h[j]] = j;
+   }
+
+   // Move h[i] up while it should be above its parent
+   template <typename T>
+   template <typename Compare>
+   inline void moving_quantile<T>::sift_up(heap& h, std::size_t i, Compare comp)
+   {
+      while (i != 0)
+      {
+         auto parent = (i - 1) / 2;
+         if (!comp(h[i], h[parent]))
+            break;
+         swap_entries(h, i, parent);
+         i = parent;
+      }
+   }
+
+   // Move h[i] down while one of its children should be above it
+   template <typename T>
+   template <typename Compare>
+   inline void moving_quantile<T>::sift_down(heap& h, std::size_t i, Compare comp)
+   {
+      auto const n = h.size();
+      while (true)
+      {
+         auto child = 2 * i + 1;
+         if (child >= n)
+            break;
+         if (child + 1 < n && comp(h[child + 1], h[child]))
+            ++child;
+         if (!comp(h[child], h[i]))
+            break;
+         swap_entries(h, i, child);
+         i = child;
+      }
+   }
+
+   template <typename T>
+   inline T moving_quantile<T>::operator()(T s)
+   {
+      auto const slot = _i;
+      if (++_i == _data.size())
+         _i = 0;
+
+      auto const old = _data[slot];
+      _data[slot] = s;
+
+      auto gt = [this](std::size_t a, std::size_t b) { return greater(a, b); };
+      auto lt = [this](std::size_t a, std::size_t b) { return less(a, b); };
+
+      // Restore the heap property where the slot is
+      if (_in_low[slot])
+      {
+         if (old < s)
+            sift_up(_low, _where[slot], gt);
+         else
+            sift_down(_low, _where[slot], gt);
+      }
+      else
+      {
+         if (s < old)
+            sift_up(_high, _where[slot], lt);
+         else
+            sift_down(_high, _where[slot], lt);
+      }
+
+      // Rebalance: the low heap's root should not exceed the high heap's root
+      if (!_high.empty() && greater(_low[0], _high[0]))
+      {
+         std::swap(_low[0], _high[0]);
+         _in_low[_low[0]] = true;
+         _in_low[_high[0]] = false;
+         _where[_low[0]] = 0;
+         _where[_high[0]] = 0;
+         sift_down(_low, 0, gt);
+         sift_down(_high, 0, lt);
+      }
+      return _data[_low[0]];
+   }
+
+   template <typename T>
+   inline T moving_quantile<T>::operator()() const
+   {
+      return _data[_low[0]];
+   }
+
+   template <typename T>
+   inline std::size_t moving_quantile<T>::size() const
+   {
+      return _data.size();
+   }
+
+   // Fill the window with val. All slots are equal, so the heaps are valid
+   // as they are.
+   template <typename T>
+   inline void moving_quantile<T>::fill(T val)
+   {
+      std::fill(_data.begin(), _data.end(), val);
+   }
 }
 
 #endif
@@ -28,17 +28,19 @@ namespace cycfi::q
    // as well as integer computations. Integers are typically faster than
    // floating point and are not prone to round-off errors.
    //
-   // moving_average is a subclass of the moving_sum.
+   // moving_average is a subclass of the moving_sum. See basic_moving_sum
+   // for the block process function and the Resync option.
    ////////////////////////////////////////////////////////////////////////////
-   template <typename T>
-   struct basic_moving_average : basic_moving_sum<T>
+   template <typename T, bool Resync = false>
+   struct basic_moving_average : basic_moving_sum<T, Resync>
    {
-      using basic_moving_sum<T>::basic_moving_sum;
+      using base_type = basic_moving_sum<T, Resync>;
+      using base_type::base_type;
       using value_type = T;
 
       T operator()(T s)
       {
-         basic_moving_sum<T>::operator()(s);
+         base_type::operator()(s);
          return (*this)();
       }
 
@@ -47,9 +49,24 @@ namespace cycfi::q
          // Return the average
          return this->sum() / this->size();
       }
+
+      void process(T const* in, T* out, std::size_t n)
+      {
+         base_type::process(in, out, n);
+         T const size = this->size();
+         for (std::size_t i = 0; i != n; ++i)
+            out[i] /= size;
+      }
+
+      template <typename U, typename V>
+      void process(iterator_range<U*> in, iterator_range<V*> out)
+      {
+         process(in.begin(), out.begin(), in.end() - in.begin());
+      }
    };
 
    using moving_average = basic_moving_average<float>;
+   using stable_moving_average = basic_moving_average<float, true>;
 
    ////////////////////////////////////////////////////////////////////////////
    // Exponential moving average approximates an arithmetic moving average by
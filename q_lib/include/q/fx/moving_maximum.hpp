@@ -7,7 +7,10 @@
 #define CYCFI_Q_EXP_MOVING_MAXIMUM_NOVEMBER_6_2019
 
 #include <q/support/base.hpp>
+#include <q/support/literals.hpp>
 #include <vector>
+#include <limits>
+#include <functional>
 
 namespace cycfi::q
 {
@@ -73,6 +76,256 @@ namespace cycfi::q
       std::size_t    _input_index;  // the actual sample placement is at (array_size + input_index);
       std::vector<T> _data;         // the big array (twice array_size);
    };
+
+   namespace detail
+   {
+      // The identity element of a sliding extremum, e.g. the lowest possible
+      // value for a sliding maximum.
+      template <typename T, typename Compare>
+      struct extremum_identity;
+
+      template <typename T>
+      struct extremum_identity<T, std::greater<T>>
+      {
+         static constexpr T value = std::numeric_limits<T>::lowest();
+      };
+
+      template <typename T>
+      struct extremum_identity<T, std::less<T>>
+      {
+         static constexpr T value = std::numeric_limits<T>::max();
+      };
+
+      template <typename Compare, typename T>
+      inline T select(T a, T b)
+      {
+         return Compare{}(a, b)? a : b;
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // monotonic_wedge: a streaming sliding extremum (maximum or minimum)
+   // using Lemire's monotonic wedge. The cost is amortized O(1) per sample,
+   // regardless of the window size: at most 2 value comparisons per sample,
+   // on average.
+   //
+   // The wedge is a deque of samples (with their positions) that are
+   // strictly ordered according to Compare. The front of the wedge is the
+   // extremum of the window. Samples that can no longer be the extremum are
+   // dropped from the back as new samples arrive, and the front sample is
+   // dropped when it falls out of the window.
+   //
+   // Lemire: "Streaming Maximum-Minimum Filter Using No More than Three
+   // Comparisons per Element", Nordic Journal of Computing, 13 (4), 2006
+   //
+   // Compare is std::greater<T> for the sliding maximum and std::less<T>
+   // for the sliding minimum (see wedge_moving_maximum and
+   // wedge_moving_minimum below).
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T, typename Compare>
+   struct monotonic_wedge
+   {
+      monotonic_wedge(duration d, float sps)
+       : monotonic_wedge(std::size_t(as_float(d) * sps))
+      {}
+
+      // A size of 0 (e.g. from a very short duration) is clamped to 1
+      monotonic_wedge(std::size_t size)
+       : _size(std::max<std::size_t>(size, 1))
+      {
+         // The wedge may momentarily hold size+1 samples before the oldest
+         // is dropped.
+         std::size_t capacity = smallest_pow2(_size + 1);
+         _mask = capacity - 1;
+         _data.resize(capacity);
+      }
+
+      T operator()(T value)
+      {
+         // Drop the samples at the back that can no longer be the extremum
+         while (_back != _front && !Compare{}(_data[(_back-1) & _mask].value, value))
+            --_back;
+
+         _data[_back++ & _mask] = { value, _pos };
+
+         // Drop the front sample if it is now outside the window
+         if (_pos - _data[_front & _mask].pos >= _size)
+            ++_front;
+
+         ++_pos;
+         return _data[_front & _mask].value;
+      }
+
+      T operator()() const
+      {
+         return (_back != _front)?
+            _data[_front & _mask].value :
+            detail::extremum_identity<T, Compare>::value;
+      }
+
+      std::size_t size() const
+      {
+         return _size;
+      }
+
+      void clear()
+      {
+         _front = _back = 0;
+      }
+
+   private:
+
+      struct entry
+      {
+         T              value;
+         std::size_t    pos;
+      };
+
+      std::size_t          _size;
+      std::size_t          _mask;
+      std::size_t          _front = 0;    // front of the wedge
+      std::size_t          _back = 0;     // one past the back of the wedge
+      std::size_t          _pos = 0;      // position of the latest sample
+      std::vector<entry>   _data;
+   };
+
+   template <typename T>
+   using wedge_moving_maximum = monotonic_wedge<T, std::greater<T>>;
+
+   template <typename T>
+   using wedge_moving_minimum = monotonic_wedge<T, std::less<T>>;
+
+   template <typename T>
+   using moving_minimum = wedge_moving_minimum<T>;
+
+   ////////////////////////////////////////////////////////////////////////////
+   // vhgw_filter: a sliding extremum (maximum or minimum) using the van
+   // Herk-Gil-Werman algorithm. The cost is 3 comparisons per sample,
+   // regardless of the window size, with no data-dependent branches.
+   //
+   // The input is divided into consecutive segments of window size. Any
+   // window straddles at most two segments: the tail of the previous
+   // segment and the head of the current segment. We keep the suffix
+   // extrema of the previous segment (computed once, in a single backward
+   // pass, when the segment completes) and the running prefix extremum of
+   // the current segment. The window's extremum is the extremum of the
+   // two.
+   //
+   // M. van Herk: "A fast algorithm for local minimum and maximum filters
+   // on rectangular and octagonal kernels", Pattern Recognition Letters 13,
+   // 1992
+   //
+   // J. Gil and M. Werman: "Computing 2-D min, median, and max filters",
+   // IEEE Transactions on Pattern Analysis and Machine Intelligence 15,
+   // 1993
+   //
+   // process(in, out, n) processes a block of samples, in runs that do not
+   // cross a segment boundary. The merge of each run with the previous
+   // segment's suffix extrema is a vectorizable element-wise operation.
+   // The result is the same as n calls to the function call operator.
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T, typename Compare>
+   struct vhgw_filter
+   {
+      vhgw_filter(duration d, float sps)
+       : vhgw_filter(std::size_t(as_float(d) * sps))
+      {}
+
+      // A size of 0 (e.g. from a very short duration) is clamped to 1
+      vhgw_filter(std::size_t size)
+       : _size(std::max<std::size_t>(size, 1))
+       , _segment(_size)
+       , _suffix(_size + 1, identity)
+      {}
+
+      T operator()(T value)
+      {
+         T r;
+         process(&value, &r, 1);
+         return r;
+      }
+
+      T operator()() const
+      {
+         return _y;
+      }
+
+      void process(T const* in, T* out, std::size_t n)
+      {
+         if (n == 0)
+            return;
+
+         while (n != 0)
+         {
+            auto const run = std::min(n, _size - _i);
+            T* seg = _segment.data() + _i;
+            T const* suffix = _suffix.data() + _i + 1;
+
+            // Prefix extremum of the current segment
+            auto prefix = _prefix;
+            for (std::size_t j = 0; j != run; ++j)
+            {
+               prefix = detail::select<Compare>(prefix, in[j]);
+               seg[j] = prefix;
+            }
+            _prefix = prefix;
+
+            // Merge with the suffix extremum of the previous segment
+            for (std::size_t j = 0; j != run; ++j)
+               out[j] = detail::select<Compare>(suffix[j], seg[j]);
+
+            // Keep the raw samples for computing the suffix extrema
+            std::copy(in, in + run, seg);
+
+            _i += run;
+            in += run;
+            out += run;
+            n -= run;
+
+            if (_i == _size)
+            {
+               // The segment is complete. Compute its suffix extrema.
+               auto* x = _segment.data();
+               auto* s = _suffix.data();
+               s[_size-1] = x[_size-1];
+               for (auto i = _size-1; i != 0; --i)
+                  s[i-1] = detail::select<Compare>(s[i], x[i-1]);
+               _i = 0;
+               _prefix = identity;
+            }
+         }
+         _y = out[-1];
+      }
+
+      std::size_t size() const
+      {
+         return _size;
+      }
+
+      void clear()
+      {
+         std::fill(_suffix.begin(), _suffix.end(), identity);
+         _i = 0;
+         _prefix = _y = identity;
+      }
+
+   private:
+
+      static constexpr T identity = detail::extremum_identity<T, Compare>::value;
+
+      std::size_t       _size;
+      std::size_t       _i = 0;              // position in the current segment
+      T                 _prefix = identity;  // running prefix extremum
+      T                 _y = identity;       // latest result
+      std::vector<T>    _segment;            // current segment samples
+      std::vector<T>    _suffix;             // previous segment suffix extrema
+   };
+
+   template <typename T>
+   using block_moving_maximum = vhgw_filter<T, std::greater<T>>;
+
+   template <typename T>
+   using block_moving_minimum = vhgw_filter<T, std::less<T>>;
 }
 
 #endif
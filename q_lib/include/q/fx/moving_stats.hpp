@@ -0,0 +1,308 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_MOVING_STATS_OCTOBER_19_2026)
+#define CYCFI_Q_MOVING_STATS_OCTOBER_19_2026
+
+#include <q/support/base.hpp>
+#include <q/support/duration.hpp>
+#include <q/utility/ring_buffer.hpp>
+#include <cmath>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // basic_moving_stats computes the mean, variance, RMS, skewness and
+   // kurtosis of the samples in a moving window, specified by size samples
+   // or duration d and float sps, using a single ring buffer.
+   //
+   // Instead of raw power sums (sum, sum of squares, etc.), which suffer
+   // from catastrophic cancellation, the mean and the central moments
+   // M2, M3 and M4 are updated using Welford's method, generalized to
+   // higher moments by Pébay. Each sample is added to the statistics, and
+   // the oldest sample, leaving the window, is removed using the exact
+   // inverse of the update.
+   //
+   // Removing samples accumulates round-off errors over time. To bound the
+   // error, fresh statistics of the incoming samples are accumulated in the
+   // background (add only, no remove). Every size() samples, the fresh
+   // statistics cover the whole window and replace the running statistics.
+   //
+   // The window starts empty. The statistics are computed over count()
+   // samples until the window is full.
+   //
+   // The block process function, process(in, n), updates the statistics
+   // with n samples, equivalent to n calls to operator()(s).
+   //
+   // See: P. Pébay, "Formulas for Robust, One-Pass Parallel Computation of
+   // Covariances and Arbitrary-Order Statistical Moments", Sandia Report
+   // SAND2008-6212, 2008.
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T>
+   class basic_moving_stats
+   {
+   public:
+
+      using value_type = T;
+
+                           basic_moving_stats(std::size_t size);
+                           basic_moving_stats(duration d, float sps);
+
+      basic_moving_stats&  operator()(T s);
+      void                 process(T const* in, std::size_t n);
+                           template <typename U>
+      void                 process(iterator_range<U*> in);
+
+      std::size_t          size() const;
+      std::size_t          count() const;
+
+      T                    mean() const;
+      T                    variance() const;
+      T                    stddev() const;
+      T                    mean_square() const;
+      T                    rms() const;
+      T                    skewness() const;
+      T                    kurtosis() const;
+
+      void                 clear();
+
+   private:
+
+      struct moments
+      {
+         void              add(T x);
+         void              remove(T x);
+
+         std::size_t       count = 0;
+         T                 mean = 0;
+         T                 m2 = 0;
+         T                 m3 = 0;
+         T                 m4 = 0;
+      };
+
+      void                 update(T x, T oldest);
+      void                 update(T x);
+
+      using buffer = ring_buffer<T>;
+
+      buffer               _buff;
+      std::size_t          _size;
+      moments              _stats;
+      moments              _fresh;
+   };
+
+   using moving_stats = basic_moving_stats<float>;
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T>
+   inline basic_moving_stats<T>::basic_moving_stats(std::size_t size)
+    : _buff(size)
+    , _size(size)
+   {
+      _buff.clear();
+   }
+
+   template <typename T>
+   inline basic_moving_stats<T>::basic_moving_stats(duration d, float sps)
+    : basic_moving_stats(std::size_t(sps * as_float(d)))
+   {}
+
+   // Add x to the moments (count -> count+1).
+   template <typename T>
+   inline void basic_moving_stats<T>::moments::add(T x)
+   {
+      T const n1 = count;
+      T const n = ++count;
+      T const delta = x - mean;
+      T const delta_n = delta / n;
+      T const delta_n2 = delta_n * delta_n;
+      T const term1 = delta * delta_n * n1;
+
+      mean += delta_n;
+      m4 += term1 * delta_n2 * (n * n - 3 * n + 3)
+         + 6 * delta_n2 * m2 - 4 * delta_n * m3;
+      m3 += term1 * delta_n * (n - 2) - 3 * delta_n * m2;
+      m2 += term1;
+   }
+
+   // Remove x from the moments (count -> count-1). This is the exact
+   // inverse of add(x).
+   template <typename T>
+   inline void basic_moving_stats<T>::moments::remove(T x)
+   {
+      if (count <= 1)
+      {
+         *this = moments{};
+         return;
+      }
+
+      T const n = count--;
+      T const delta_n = (x - mean) / (n - 1);
+      T const delta_n2 = delta_n * delta_n;
+      T const term1 = (x - mean) * delta_n * n;
+
+      mean -= delta_n;
+      m2 -= term1;
+      m3 -= term1 * delta_n * (n - 2) - 3 * delta_n * m2;
+      m4 -= term1 * delta_n2 * (n * n - 3 * n + 3)
+         + 6 * delta_n2 * m2 - 4 * delta_n * m3;
+
+      // Round-off may leave a tiny negative M2
+      if (m2 < 0)
+         m2 = 0;
+   }
+
+   // Add x while the window is not yet full
+   template <typename T>
+   inline void basic_moving_stats<T>::update(T x)
+   {
+      _stats.add(x);
+      _fresh.add(x);
+      if (_fresh.count == _size)
+         _fresh = moments{};
+   }
+
+   // Add x and remove the oldest sample leaving the window
+   template <typename T>
+   inline void basic_moving_stats<T>::update(T x, T oldest)
+   {
+      _stats.remove(oldest);
+      _stats.add(x);
+      _fresh.add(x);
+      if (_fresh.count == _size)
+      {
+         // The fresh moments now cover the whole window
+         _stats = _fresh;
+         _fresh = moments{};
+      }
+   }
+
+   template <typename T>
+   inline basic_moving_stats<T>& basic_moving_stats<T>::operator()(T s)
+   {
+      if (_stats.count == _size)
+         update(s, _buff[_size-1]);
+      else
+         update(s);
+      _buff.push(s);
+      return *this;
+   }
+
+   template <typename T>
+   inline void basic_moving_stats<T>::process(T const* in, std::size_t n)
+   {
+      // Fill the window first
+      std::size_t i = 0;
+      for (; i != n && _stats.count != _size; ++i)
+      {
+         update(in[i]);
+         _buff.push(in[i]);
+      }
+      if (i == n)
+         return;
+
+      // Then read the outgoing samples in contiguous runs. The first k
+      // outgoing samples are in the buffer, the rest are the input samples
+      // themselves.
+      auto const rest = n - i;
+      auto const k = std::min(rest, _size);
+      auto [a, b] = _buff.segments(_size - k, k);
+      T const* s = in + i;
+      for (auto x : a)
+         update(*s++, x);
+      for (auto x : b)
+         update(*s++, x);
+      for (std::size_t j = k; j != rest; ++j, ++s)
+         update(*s, s[-std::ptrdiff_t(_size)]);
+      _buff.push(in + i, rest);
+   }
+
+   template <typename T>
+   template <typename U>
+   inline void basic_moving_stats<T>::process(iterator_range<U*> in)
+   {
+      process(in.begin(), in.end() - in.begin());
+   }
+
+   // Get the window size (in samples).
+   template <typename T>
+   inline std::size_t basic_moving_stats<T>::size() const
+   {
+      return _size;
+   }
+
+   // Get the number of samples in the window.
+   template <typename T>
+   inline std::size_t basic_moving_stats<T>::count() const
+   {
+      return _stats.count;
+   }
+
+   template <typename T>
+   inline T basic_moving_stats<T>::mean() const
+   {
+      return _stats.mean;
+   }
+
+   // Population variance: M2 / count
+   template <typename T>
+   inline T basic_moving_stats<T>::variance() const
+   {
+      return _stats.count? _stats.m2 / _stats.count : 0;
+   }
+
+   template <typename T>
+   inline T basic_moving_stats<T>::stddev() const
+   {
+      return std::sqrt(variance());
+   }
+
+   // Mean of the squared samples: variance + mean^2
+   template <typename T>
+   inline T basic_moving_stats<T>::mean_square() const
+   {
+      return variance() + _stats.mean * _stats.mean;
+   }
+
+   template <typename T>
+   inline T basic_moving_stats<T>::rms() const
+   {
+      return std::sqrt(mean_square());
+   }
+
+   // Population skewness: sqrt(n) * M3 / M2^1.5. Returns 0 if the variance
+   // is 0.
+   template <typename T>
+   inline T basic_moving_stats<T>::skewness() const
+   {
+      auto const& m = _stats;
+      if (m.m2 <= 0)
+         return 0;
+      return std::sqrt(T(m.count)) * m.m3 / (m.m2 * std::sqrt(m.m2));
+   }
+
+   // Population excess kurtosis: n * M4 / M2^2 - 3. Returns 0 if the
+   // variance is 0.
+   template <typename T>
+   inline T basic_moving_stats<T>::kurtosis() const
+   {
+      auto const& m = _stats;
+      if (m.m2 <= 0)
+         return 0;
+      return T(m.count) * m.m4 / (m.m2 * m.m2) - 3;
+   }
+
+   template <typename T>
+   inline void basic_moving_stats<T>::clear()
+   {
+      _buff.clear();
+      _stats = moments{};
+      _fresh = moments{};
+   }
+}
+
+#endif
@@ -9,6 +9,7 @@
 #include <q/support/base.hpp>
 #include <q/support/frequency.hpp>
 #include <q/utility/ring_buffer.hpp>
+#include <q/detail/prefix_sum.hpp>
 
 namespace cycfi::q
 {
@@ -21,16 +22,32 @@ namespace cycfi::q
    // update=true, when downsizing, the oldest elements are subtracted from
    // the sum. When upsizing, the older elements are added to the sum,
    // otherwise, if update=false, the contents are cleared.
+   //
+   // The block process function, process(in, out, n), computes the n moving
+   // sums for the n input samples, equivalent to n calls to operator()(s).
+   // It computes the differences between the incoming and outgoing samples
+   // in one pass, followed by a (SIMD) prefix sum of the differences. in
+   // and out may point to the same buffer (in-place processing).
+   //
+   // With floating point, the running sum accumulates round-off errors and
+   // drifts over time. Without Resync, the running sum is kept in double
+   // precision (for float), which slows down the drift but does not stop
+   // it. With Resync=true, the sums are kept in T (no doubles), with
+   // Neumaier compensation, and the running sum is periodically replaced by
+   // a fresh sum of the samples in the window, accumulated in the
+   // background and restarted every size() samples. The error is then
+   // bounded by the round-off accumulated over two windows, regardless of
+   // running time.
    ////////////////////////////////////////////////////////////////////////////
-   template <typename T>
+   template <typename T, bool Resync = false>
    struct basic_moving_sum
    {
       using value_type = T;
 
+      // A size of 0 (e.g. from a very short duration) is clamped to 1
       basic_moving_sum(std::size_t max_size)
-       : _buff(max_size)
-       , _size(max_size)
-       , _sum{ 0 }
+       : _buff(std::max<std::size_t>(max_size, 1))
+       , _size(std::max<std::size_t>(max_size, 1))
       {
          _buff.clear();
       }
@@ -41,20 +58,42 @@ namespace cycfi::q
 
       T operator()(value_type s)
       {
-         _sum += s;              // Add the latest sample to the sum
-         _sum -= _buff[_size-1]; // Subtract the oldest sample from the sum
-         _buff.push(s);          // Push the latest sample, erasing the oldest
-         return _sum;
+         add(_sum, s);              // Add the latest sample to the sum
+         add(_sum, -_buff[_size-1]);// Subtract the oldest sample from the sum
+         _buff.push(s);             // Push the latest sample, erasing the oldest
+         if constexpr (Resync)
+            resync(s);
+         return sum();
+      }
+
+      void process(T const* in, T* out, std::size_t n)
+      {
+         // Process in chunks of at most chunk_size samples. With Resync,
+         // the chunks also end at the resync points.
+         for (std::size_t done = 0; done != n;)
+         {
+            auto m = std::min(n - done, chunk_size);
+            if constexpr (Resync)
+               m = std::min(m, _size - _count);
+            process_block(in + done, out + done, m);
+            done += m;
+         }
+      }
+
+      template <typename U, typename V>
+      void process(iterator_range<U*> in, iterator_range<V*> out)
+      {
+         process(in.begin(), out.begin(), in.end() - in.begin());
       }
 
       value_type operator()() const
       {
-         return _sum;            // Return the sum
+         return sum();              // Return the sum
       }
 
       value_type sum() const
       {
-         return _sum;            // Return the sum
+         return _sum.value();       // Return the sum
       }
 
       std::size_t size() const
@@ -64,20 +103,21 @@ namespace cycfi::q
 
       void resize(std::size_t size, bool update = false)
       {
-         // We cannot exceed the original size
-         auto new_size = std::min(size, _buff.size());
+         // We cannot exceed the original size, and a size of 0 is
+         // clamped to 1
+         auto new_size = std::clamp<std::size_t>(size, 1, _buff.size());
 
          if (update)
          {
             if (new_size > _size) // expand
             {
                for (auto i = _size; i != new_size; ++i)
-                  _sum += _buff[i];
+                  add(_sum, _buff[i]);
             }
             else // contract
             {
                for (auto i = new_size; i != _size; ++i)
-                  _sum -= _buff[i];
+                  add(_sum, -_buff[i]);
             }
          }
          else
@@ -85,6 +125,7 @@ namespace cycfi::q
             clear();
          }
          _size = new_size;
+         restart();
       }
 
       void resize(duration d, float sps, bool update = false)
@@ -95,26 +136,130 @@ namespace cycfi::q
       void clear()
       {
          _buff.clear();
-         _sum = 0;
+         _sum = {};
+         restart();
       }
 
       void fill(T val)
       {
          _buff.fill(val);
-         _sum = val * _size;
+         _sum = { accumulator(val * _size) };
+         restart();
       }
 
    private:
 
       using buffer = ring_buffer<T>;
-      using accumulator = decltype(promote(T()));
 
-      buffer      _buff = buffer{};
-      std::size_t _size;
-      accumulator _sum;
+      // Without Resync, the running sum is kept in the promoted type (e.g.
+      // double for float), same as before. With Resync, the sums are kept
+      // in T with Neumaier compensation, so that the error stays within a
+      // few ulps of the sum without paying for doubles.
+      using accumulator = std::conditional_t<
+         Resync, T, decltype(promote(T()))>;
+
+      struct compensated_sum
+      {
+         T value() const { return static_cast<T>(sum + c); }
+
+         accumulator sum = 0;
+         accumulator c = 0;
+      };
+
+      static constexpr std::size_t chunk_size = 256;
+
+      static void add(compensated_sum& s, accumulator x)
+      {
+         if constexpr (Resync && std::is_floating_point_v<T>)
+         {
+            // Neumaier summation
+            auto t = s.sum + x;
+            if (std::abs(s.sum) >= std::abs(x))
+               s.c += (s.sum - t) + x;
+            else
+               s.c += (x - t) + s.sum;
+            s.sum = t;
+         }
+         else
+         {
+            s.sum += x;
+         }
+      }
+
+      // Processes n <= chunk_size samples. in and out may alias.
+      void process_block(T const* in, T* out, std::size_t n)
+      {
+         // Compute the differences between the incoming samples and the
+         // outgoing samples into a scratch chunk. The first k outgoing
+         // samples are in the buffer, the rest are the input samples
+         // themselves. out is written only after all the inputs are read
+         // and pushed, so that in-place processing works.
+         T diff[chunk_size];
+         auto const k = std::min(n, _size);
+         auto [a, b] = _buff.segments(_size - k, k);
+         std::size_t i = 0;
+         for (auto p = a.begin(); p != a.end(); ++p, ++i)
+            diff[i] = in[i] - *p;
+         for (auto p = b.begin(); p != b.end(); ++p, ++i)
+            diff[i] = in[i] - *p;
+         for (; i != n; ++i)
+            diff[i] = in[i] - in[i - _size];
+
+         if constexpr (Resync)
+         {
+            for (i = 0; i != n; ++i)
+               add(_fresh_sum, in[i]);
+         }
+         _buff.push(in, n);
+
+         // The moving sums are the prefix sums of the differences. The
+         // prefix sums start from 0 and the running sum is added back, so
+         // that the running sum keeps the accumulator's precision, same as
+         // operator()(s). The outputs are rounded once, but the rounding
+         // does not accumulate.
+         auto const offset = sum();
+         auto const last = detail::prefix_sum(diff, n, T(0));
+         for (i = 0; i != n; ++i)
+            out[i] = diff[i] + offset;
+         add(_sum, last);
+
+         if constexpr (Resync)
+         {
+            if ((_count += n) == _size)
+               sync();
+         }
+      }
+
+      void resync(T s)
+      {
+         add(_fresh_sum, s);
+         if (++_count == _size)
+            sync();
+      }
+
+      // The fresh sum now covers the whole window. Replace the running sum
+      // and start over.
+      void sync()
+      {
+         _sum = _fresh_sum;
+         restart();
+      }
+
+      void restart()
+      {
+         _fresh_sum = {};
+         _count = 0;
+      }
+
+      buffer            _buff = buffer{};
+      std::size_t       _size;
+      compensated_sum   _sum;
+      compensated_sum   _fresh_sum;
+      std::size_t       _count = 0;
    };
 
    using moving_sum = basic_moving_sum<float>;
+   using stable_moving_sum = basic_moving_sum<float, true>;
 }
 
 #endif
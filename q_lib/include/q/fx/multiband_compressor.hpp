@@ -0,0 +1,319 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_MULTIBAND_COMPRESSOR_OCTOBER_19_2026)
+#define CYCFI_Q_MULTIBAND_COMPRESSOR_OCTOBER_19_2026
+
+#include <q/support/literals.hpp>
+#include <q/support/decibel.hpp>
+#include <q/fx/biquad.hpp>
+#include <q/fx/dynamic.hpp>
+#include <q/fx/envelope_bank.hpp>
+#include <array>
+#include <algorithm>
+#include <utility>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // linkwitz_riley_crossover: splits a signal into low and high bands using
+   // 4th order Linkwitz-Riley filters (two cascaded 2nd order Butterworth
+   // biquads for each band). The low and high bands are in phase and sum
+   // to a 2nd order allpass response (flat magnitude) with the same corner
+   // frequency, which is what linkwitz_riley_allpass computes.
+   ////////////////////////////////////////////////////////////////////////////
+   struct linkwitz_riley_crossover
+   {
+               linkwitz_riley_crossover(frequency f, float sps);
+
+      void     config(frequency f, float sps);
+      void     process(float const* in, float* low, float* high, std::size_t n);
+
+      static constexpr double butterworth_q = 0.70710678118654752;
+
+      lowpass  _lp1, _lp2;
+      highpass _hp1, _hp2;
+   };
+
+   struct linkwitz_riley_allpass : allpass
+   {
+      linkwitz_riley_allpass(frequency f, float sps)
+       : allpass(f, sps, linkwitz_riley_crossover::butterworth_q)
+      {}
+
+      void config(frequency f, float sps)
+      {
+         allpass::config(f, sps, linkwitz_riley_crossover::butterworth_q);
+      }
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // multiband_compressor: a B band (2 to 5) compressor.
+   //
+   // The signal is split into B bands by a tree of B-1
+   // linkwitz_riley_crossovers at increasing crossover frequencies. Each
+   // band below a crossover is passed through a matching
+   // linkwitz_riley_allpass so that all bands have the same phase response
+   // and the bands sum to an allpass response (phase coherent, with a flat
+   // magnitude response).
+   //
+   // Each band has its own soft_knee_compressor and makeup gain. The band
+   // envelopes are computed using the same algorithm as the
+   // fast_rms_envelope_follower_db. All bands are tracked by one
+   // fast_ave_envelope_follower_bank (SoA, vectorized across bands). The
+   // envelopes are converted to dB, and the gains back from dB, per band
+   // over the whole chunk, using the block to_db and from_db, which
+   // vectorize.
+   //
+   // The compressor is block processed, in chunks, with the band signals
+   // kept in small buffers on the stack. Each band compressor is initially
+   // set to a ratio of 1 (no compression).
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t B>
+   class multiband_compressor
+   {
+   public:
+
+      static_assert(B >= 2 && B <= 5, "Error: B must be from 2 to 5");
+
+      static constexpr std::size_t num_bands = B;
+      using crossovers_type = std::array<frequency, B-1>;
+
+                  multiband_compressor(
+                     crossovers_type const& crossovers
+                   , duration hold
+                   , float sps
+                  );
+
+      void        process(float const* in, float* out, std::size_t n);
+
+      void        crossover(std::size_t k, frequency f, float sps);
+      void        compressor(
+                     std::size_t band
+                   , decibel threshold
+                   , decibel width
+                   , float ratio
+                  );
+      void        makeup(std::size_t band, decibel gain);
+      decibel     gain(std::size_t band) const;
+
+   private:
+
+      static constexpr std::size_t chunk_size = 64;
+      static constexpr auto threshold = fast_rms_envelope_follower::threshold;
+
+      using bands_type = std::array<std::array<float, chunk_size>, B>;
+
+      void        split(float const* in, bands_type& bands, std::size_t n);
+
+      std::array<linkwitz_riley_crossover, B-1>    _xover;
+
+      // _ap[k][j] is the allpass for band j (j < k) at crossover k
+      std::array<std::array<linkwitz_riley_allpass, B-1>, B-1> _ap;
+
+      fast_ave_envelope_follower_bank<B>           _env;
+      std::array<soft_knee_compressor, B>          _comp;
+      std::array<decibel, B>                       _makeup;
+      std::array<decibel, B>                       _gain;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+
+   ////////////////////////////////////////////////////////////////////////////
+   // linkwitz_riley_crossover
+   inline linkwitz_riley_crossover::linkwitz_riley_crossover(
+      frequency f, float sps)
+    : _lp1(f, sps, butterworth_q)
+    , _lp2(f, sps, butterworth_q)
+    , _hp1(f, sps, butterworth_q)
+    , _hp2(f, sps, butterworth_q)
+   {}
+
+   inline void linkwitz_riley_crossover::config(frequency f, float sps)
+   {
+      _lp1.config(f, sps, butterworth_q);
+      _lp2.config(f, sps, butterworth_q);
+      _hp1.config(f, sps, butterworth_q);
+      _hp2.config(f, sps, butterworth_q);
+   }
+
+   // Split n samples from in into low and high. in may be the same as low
+   // or high, but not both.
+   inline void linkwitz_riley_crossover::process(
+      float const* in, float* low, float* high, std::size_t n)
+   {
+      if (in == high)
+      {
+         _lp1.process(in, low, n);
+         _lp2.process(low, low, n);
+         _hp1.process(in, high, n);
+         _hp2.process(high, high, n);
+      }
+      else
+      {
+         _hp1.process(in, high, n);
+         _hp2.process(high, high, n);
+         _lp1.process(in, low, n);
+         _lp2.process(low, low, n);
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // multiband_compressor
+   namespace detail
+   {
+      template <std::size_t... I>
+      inline std::array<linkwitz_riley_crossover, sizeof...(I)>
+      make_crossovers(
+         std::array<frequency, sizeof...(I)> const& f
+       , float sps
+       , std::index_sequence<I...>)
+      {
+         return { linkwitz_riley_crossover(f[I], sps)... };
+      }
+
+      template <typename T, std::size_t... I>
+      inline std::array<T, sizeof...(I)>
+      make_filled_array(T const& val, std::index_sequence<I...>)
+      {
+         return { (void(I), val)... };
+      }
+
+      // Row k has the allpass filters at crossover k
+      template <std::size_t... K>
+      inline std::array<std::array<linkwitz_riley_allpass, sizeof...(K)>, sizeof...(K)>
+      make_allpass_matrix(
+         std::array<frequency, sizeof...(K)> const& f
+       , float sps
+       , std::index_sequence<K...> seq)
+      {
+         return { make_filled_array(linkwitz_riley_allpass(f[K], sps), seq)... };
+      }
+   }
+
+   template <std::size_t B>
+   inline multiband_compressor<B>::multiband_compressor(
+      crossovers_type const& crossovers
+    , duration hold
+    , float sps
+   )
+    : _xover(detail::make_crossovers(
+         crossovers, sps, std::make_index_sequence<B-1>{}))
+    , _ap(detail::make_allpass_matrix(
+         crossovers, sps, std::make_index_sequence<B-1>{}))
+    , _env(hold, sps)
+    , _comp(detail::make_filled_array(
+         soft_knee_compressor{ 0_dB, 0_dB, 1.0f }, std::make_index_sequence<B>{}))
+   {
+      _makeup.fill(0_dB);
+      _gain.fill(0_dB);
+   }
+
+   template <std::size_t B>
+   inline void multiband_compressor<B>::split(
+      float const* in, bands_type& bands, std::size_t n)
+   {
+      // bands[B-1] holds the signal above the current crossover
+      auto* rest = bands[B-1].data();
+      std::copy(in, in + n, rest);
+      for (std::size_t k = 0; k != B-1; ++k)
+      {
+         _xover[k].process(rest, bands[k].data(), rest, n);
+
+         // Phase compensation of the lower bands
+         for (std::size_t j = 0; j != k; ++j)
+            _ap[k][j].process(bands[j].data(), bands[j].data(), n);
+      }
+   }
+
+   template <std::size_t B>
+   inline void multiband_compressor<B>::process(
+      float const* in, float* out, std::size_t n)
+   {
+      bands_type bands;
+      bands_type gains;
+      for (std::size_t i = 0; i < n; i += chunk_size)
+      {
+         auto const m = std::min(n - i, chunk_size);
+         split(in + i, bands, m);
+
+         // Envelope of all bands (mean square)
+         for (std::size_t j = 0; j != m; ++j)
+         {
+            frame<B> sq;
+            for (std::size_t b = 0; b != B; ++b)
+               sq[b] = bands[b][j] * bands[b][j];
+            auto const& e = _env(sq);
+            for (std::size_t b = 0; b != B; ++b)
+               gains[b][j] = (e[b] < threshold)? 0.0f : e[b];
+         }
+
+         // Gain computation, in dB, with the conversions to and from dB
+         // done per band over the whole chunk
+         for (std::size_t b = 0; b != B; ++b)
+         {
+            auto* g = gains[b].data();
+            to_db(g, g, m);
+            for (std::size_t j = 0; j != m; ++j)
+            {
+               // Square root in the dB domain, same as
+               // fast_rms_envelope_follower_db
+               auto env = decibel{g[j] / 2.0f, decibel::direct};
+               g[j] = (_comp[b](env) + _makeup[b]).rep;
+            }
+            _gain[b] = decibel{g[m-1], decibel::direct};
+            from_db(g, g, m);
+         }
+
+         // Sum of all bands
+         for (std::size_t j = 0; j != m; ++j)
+         {
+            float y = 0.0f;
+            for (std::size_t b = 0; b != B; ++b)
+               y += bands[b][j] * gains[b][j];
+            out[i+j] = y;
+         }
+      }
+   }
+
+   // Set the k-th crossover frequency. The crossover frequencies must be
+   // in increasing order.
+   template <std::size_t B>
+   inline void multiband_compressor<B>::crossover(
+      std::size_t k, frequency f, float sps)
+   {
+      _xover[k].config(f, sps);
+      for (auto& ap : _ap[k])
+         ap.config(f, sps);
+   }
+
+   template <std::size_t B>
+   inline void multiband_compressor<B>::compressor(
+      std::size_t band
+    , decibel threshold
+    , decibel width
+    , float ratio
+   )
+   {
+      _comp[band] = soft_knee_compressor{ threshold, width, ratio };
+   }
+
+   template <std::size_t B>
+   inline void multiband_compressor<B>::makeup(std::size_t band, decibel gain)
+   {
+      _makeup[band] = gain;
+   }
+
+   // Get the latest gain (compression plus makeup) of a band, for metering.
+   template <std::size_t B>
+   inline decibel multiband_compressor<B>::gain(std::size_t band) const
+   {
+      return _gain[band];
+   }
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_MULTITAP_DELAY_OCTOBER_19_2026)
+#define CYCFI_Q_MULTITAP_DELAY_OCTOBER_19_2026
+
+#include <q/utility/ring_buffer.hpp>
+#include <q/support/base.hpp>
+#include <q/support/duration.hpp>
+#include <array>
+#include <cmath>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // multitap_delay: a delay line with N fractional (linearly interpolated)
+   // taps, read all at once.
+   //
+   // The tap positions are set using tap(k, delay), where delay is in
+   // samples (delay >= 1) or a duration. The integer index and the
+   // interpolation fraction of each tap are computed only when the tap is
+   // set, not per sample.
+   //
+   // The function call operator, operator()(s), reads all the taps, pushes
+   // s and returns the N tap outputs. The block process function,
+   // process(in, out, n), processes a block of n samples into N output
+   // blocks (one per tap). The block process reads each tap as a run of
+   // contiguous samples, in sub-blocks no longer than the shortest tap, and
+   // interpolates the run in a tight (vectorizable) loop.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   class multitap_delay : public ring_buffer<float>
+   {
+   public:
+
+      using base_type = ring_buffer<float>;
+      using taps_type = std::array<float, N>;
+
+                        multitap_delay(duration max_delay, float sps);
+      explicit          multitap_delay(std::size_t max_delay_samples);
+
+      void              tap(std::size_t k, float delay);
+      void              tap(std::size_t k, duration delay, float sps);
+      float             tap(std::size_t k) const;
+
+      taps_type         operator()(float s);
+      taps_type         operator()() const;
+      void              process(
+                           float const* in
+                         , std::array<float*, N> const& out
+                         , std::size_t n
+                        );
+
+   private:
+
+      std::array<std::size_t, N> _index;
+      std::array<float, N>       _frac;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   inline multitap_delay<N>::multitap_delay(duration max_delay, float sps)
+    : multitap_delay(std::size_t(std::ceil(as_double(max_delay) * sps)))
+   {}
+
+   template <std::size_t N>
+   inline multitap_delay<N>::multitap_delay(std::size_t max_delay_samples)
+    : base_type(max_delay_samples + 1)
+   {
+      _index.fill(0);
+      _frac.fill(0.0f);
+   }
+
+   // Set the k-th tap delay, in samples. The delay must be at least 1
+   // sample and less than size() samples.
+   template <std::size_t N>
+   inline void multitap_delay<N>::tap(std::size_t k, float delay)
+   {
+      // Reading before pushing gives an additional 1 sample delay
+      auto i = std::max(delay - 1.0f, 0.0f);
+      _index[k] = std::min(std::size_t(i), size() - 2);
+      _frac[k] = i - _index[k];
+   }
+
+   // Set the k-th tap delay, given a duration and the sample rate.
+   template <std::size_t N>
+   inline void multitap_delay<N>::tap(std::size_t k, duration delay, float sps)
+   {
+      tap(k, float(as_double(delay) * sps));
+   }
+
+   // Get the k-th tap delay, in samples.
+   template <std::size_t N>
+   inline float multitap_delay<N>::tap(std::size_t k) const
+   {
+      return _index[k] + _frac[k] + 1.0f;
+   }
+
+   // Get the current tap outputs.
+   template <std::size_t N>
+   inline typename multitap_delay<N>::taps_type
+   multitap_delay<N>::operator()() const
+   {
+      taps_type y1, y2;
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         y1[k] = (*this)[_index[k]];
+         y2[k] = (*this)[_index[k] + 1];
+      }
+
+      // Interpolate all taps in one pass
+      taps_type r;
+      for (std::size_t k = 0; k != N; ++k)
+         r[k] = y1[k] + _frac[k] * (y2[k] - y1[k]);
+      return r;
+   }
+
+   // Read all taps and push the latest sample, s.
+   template <std::size_t N>
+   inline typename multitap_delay<N>::taps_type
+   multitap_delay<N>::operator()(float s)
+   {
+      auto r = (*this)();
+      this->push(s);
+      return r;
+   }
+
+   // Process a block of n samples. out[k] receives the n samples of the
+   // k-th tap. This is equivalent to n calls to operator()(s).
+   template <std::size_t N>
+   inline void multitap_delay<N>::process(
+      float const* in
+    , std::array<float*, N> const& out
+    , std::size_t n
+   )
+   {
+      // We can read a sub-block of m samples from the current contents of
+      // the buffer as long as m is not more than the shortest tap delay.
+      auto const min_index = *std::min_element(_index.begin(), _index.end());
+      auto const max_m = min_index + 1;
+
+      for (std::size_t done = 0; done != n;)
+      {
+         auto const m = std::min(max_m, n - done);
+         for (std::size_t k = 0; k != N; ++k)
+         {
+            // The m+1 samples from b[index+1] (oldest) to b[index-m+1]
+            // (latest), in chronological order. Output sample j is the
+            // interpolation between samples j+1 and j of that run.
+            auto [a, b] = this->segments(_index[k] - m + 1, m + 1);
+            auto const f = _frac[k];
+            float* y = out[k] + done;
+
+            auto lerp_run = [f](float const* p, float* y, std::size_t count)
+            {
+               for (std::size_t j = 0; j != count; ++j)
+                  y[j] = p[j+1] + f * (p[j] - p[j+1]);
+            };
+
+            std::size_t const na = a.end() - a.begin();
+            if (na > m)
+            {
+               lerp_run(a.begin(), y, m);
+            }
+            else
+            {
+               // The run wraps around the end of the storage
+               lerp_run(a.begin(), y, na - 1);
+               float const seam[] = { a.end()[-1], *b.begin() };
+               lerp_run(seam, y + na - 1, 1);
+               lerp_run(b.begin(), y + na, m - na);
+            }
+         }
+         this->push(in + done, m);
+         done += m;
+      }
+   }
+}
+
+#endif
@@ -18,6 +18,14 @@ namespace cycfi::q
    ////////////////////////////////////////////////////////////////////////////
    // signal_conditioner preprocesses and enhances a signal for analytical
    // processes such as onset and pitch detection.
+   //
+   // The block process function, process(in, out, n), is equivalent to n
+   // calls to operator()(s). All stages are fused into one loop, with the
+   // high pass and dynamic smoother states kept in registers, and the
+   // compressor and makeup gain computed with one gain_table lookup. The
+   // recursive stages are latency bound, so keeping them in one loop lets
+   // the CPU overlap their dependency chains. In-place processing (in ==
+   // out) is allowed.
    ////////////////////////////////////////////////////////////////////////////
    class signal_conditioner
    {
@@ -49,6 +57,7 @@ namespace cycfi::q
                               );
 
       float                   operator()(float s);
+      void                    process(float const* in, float* out, std::size_t n);
       bool                    gate() const;
       float                   gate_env() const;
       float                   pre_env() const;
@@ -66,8 +75,7 @@ namespace cycfi::q
       dynamic_smoother        _sm;
       fast_envelope_follower  _env;
       float                   _post_env;
-      compressor              _comp;
-      float                   _makeup_gain;
+      gain_table<compressor>  _comp;
       onset_gate              _gate;
       ar_envelope_follower    _gate_env;
    };
@@ -86,8 +94,10 @@ namespace cycfi::q
     , _hp{lowest_freq, sps}
     , _sm{lowest_freq + ((highest_freq - lowest_freq) / 2), sps}
     , _env{lowest_freq.period()*0.6, sps}
-    , _comp{conf.comp_threshold, conf.comp_slope}
-    , _makeup_gain{conf.comp_gain}
+    , _comp{
+         compressor{conf.comp_threshold, conf.comp_slope}
+       , decibel(conf.comp_gain)
+      }
     , _gate{
          conf.gate_onset_threshold
        , conf.gate_release_threshold
@@ -116,14 +126,50 @@ namespace cycfi::q
       s *= _gate_env(gate);
 
       // Compressor + makeup-gain
-      auto env_db = decibel(env);
-      auto gain = as_float(_comp(env_db)) * _makeup_gain;
+      auto gain = _comp(env);
       s = s * gain;
       _post_env = env * gain;
 
       return s;
    }
 
+   inline void signal_conditioner::process(
+      float const* in, float* out, std::size_t n)
+   {
+      // Local copies of the high pass, pre clip and dynamic smoother, with
+      // their states kept in registers
+      auto const hp = _hp;
+      auto const clip_ = _clip;
+      auto const sm = _sm;
+      auto hp_state = hp.get_state();
+      auto sm_state = sm.get_state();
+      auto post_env = _post_env;
+
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         // High pass
+         auto s = hp.step(in[i], hp_state);
+
+         // Pre clip
+         s = clip_(s);
+
+         // Dynamic Smoother
+         s = sm.step(s, sm_state);
+
+         // Signal envelope
+         auto env = _env(std::abs(s));
+
+         // Noise gate, compressor + makeup-gain
+         auto gain = _comp(env);
+         out[i] = s * _gate_env(_gate(env)) * gain;
+         post_env = env * gain;
+      }
+
+      _hp.set_state(hp_state);
+      _sm.set_state(sm_state);
+      _post_env = post_env;
+   }
+
    inline bool signal_conditioner::gate() const
    {
       return _gate();
@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <cstring>
 #include <algorithm>
+#include <cmath>
 #include <infra/support.hpp>
 #include <q/detail/fast_math.hpp>
 
@@ -79,6 +80,29 @@ namespace cycfi::q
       return fastercos(x);
    }
 
+   ////////////////////////////////////////////////////////////////////////////
+   // sin(2pi x), x in [ -0.5, 0.5 ] (cycles), using a polynomial, without
+   // branches or calls, so it can be vectorized. x is reflected into
+   // [-0.25, 0.25], where an 11th order Taylor polynomial is accurate to
+   // float precision (max error about 1e-7).
+   ////////////////////////////////////////////////////////////////////////////
+   inline float poly_sin_2pi(float x)
+   {
+      constexpr float c1 = 2 * pi;
+      constexpr float c3 = -c1 * c1 * c1 / 6;
+      constexpr float c5 = -c3 * c1 * c1 / 20;
+      constexpr float c7 = -c5 * c1 * c1 / 42;
+      constexpr float c9 = -c7 * c1 * c1 / 72;
+      constexpr float c11 = -c9 * c1 * c1 / 110;
+
+      // sin(2pi x) = sign(x) * sin(2pi r), r = min(|x|, 0.5 - |x|)
+      float a = std::abs(x);
+      float r = std::min(a, 0.5f - a);
+      float z = r * r;
+      float y = r * (c1 + z * (c3 + z * (c5 + z * (c7 + z * (c9 + z * c11)))));
+      return std::copysign(y, x);
+   }
+
    ////////////////////////////////////////////////////////////////////////////
    // fast pade-approximation of the tanh function (x should be: -3 <= x <= 3)
    ////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,371 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_BLOCK_MATH_OCTOBER_19_2026)
+#define CYCFI_Q_BLOCK_MATH_OCTOBER_19_2026
+
+#include <q/support/base.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// The block functions are compiled for several targets, and the best one
+// for the CPU is selected at load time (ifunc). The clones must not use FMA
+// (AVX-512F has FMA instructions), so that all targets compute the same
+// results. Clang ignores the optimize attribute and contracts a * b + c by
+// default, so with Clang there is no AVX-512 clone.
+#if defined(__has_attribute)
+# if __has_attribute(target_clones) && defined(__GLIBC__) \
+   && (defined(__x86_64__) || defined(__i386__)) && !defined(__AVX512F__)
+#  if defined(__clang__)
+#   define CYCFI_Q_BLOCK_MATH_DISPATCH \
+      __attribute__((target_clones("avx2", "default")))
+#  else
+#   define CYCFI_Q_BLOCK_MATH_DISPATCH \
+      __attribute__((target_clones("avx512f", "avx2", "default"), \
+         optimize("fp-contract=off")))
+#  endif
+# endif
+#endif
+
+#if !defined(CYCFI_Q_BLOCK_MATH_DISPATCH)
+# define CYCFI_Q_BLOCK_MATH_DISPATCH
+#endif
+
+// detail::transform must be inlined into each clone to be compiled for its
+// target (at -O2, GCC does not inline it otherwise).
+#if defined(__GNUC__)
+# define CYCFI_Q_BLOCK_MATH_INLINE inline __attribute__((always_inline))
+#else
+# define CYCFI_Q_BLOCK_MATH_INLINE inline
+#endif
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Vectorizable math functions.
+   //
+   // The poly_xxx functions are branch-free polynomial approximations
+   // (range reduction using the float exponent bits, as in Cephes), with
+   // no calls or table lookups, so loops calling them are vectorized by
+   // the compiler. The block functions in namespace block apply them to
+   // arrays:
+   //
+   //    block::exp(in, out, n);    // out[i] = poly_exp(in[i])
+   //
+   // in and out may be the same array. The samples are processed in
+   // chunks of 32, which GCC vectorizes with -O2 or -O3.
+   //
+   // On x86 with GCC or Clang (glibc), the block functions are compiled
+   // for AVX-512 (16 floats), AVX2 (8 floats) and the default target (SSE2
+   // on x86-64, 4 floats), and are dispatched at runtime to the best one
+   // supported by the CPU. Elsewhere, the instruction set is fixed at
+   // compile time by the target flags. The clones do not use FMA, so all
+   // targets compute the same results as the scalar poly_xxx functions.
+   //
+   // Accuracy (max error, measured against double precision):
+   //
+   //    poly_pow2      x in [-126, 127]           1.3 ulp
+   //    poly_exp       x in [-87, 88]             1.3 ulp
+   //    poly_log2      x >= FLT_MIN               2 ulp (1e-7 near 1)
+   //    poly_log10     x >= FLT_MIN               2.2 ulp
+   //    poly_sin/cos   |x| <= 2pi                 8e-7 absolute
+   //                   |x| <= 1000                1e-4 absolute
+   //    poly_tanh      all x                      1.4 ulp
+   //    poly_db2a      x in [-120, 24] dB         8e-7 relative
+   //    poly_a2db      a >= FLT_MIN               2 ulp (7e-6 dB at -120 dB)
+   //
+   // (ulp: units in the last place of the result). The db2a error is
+   // that of rounding x * log2(10)/20, and grows with |x| (3e-6 at -758
+   // dB). By comparison, fast_log2 is accurate to 1.5e-4, fast_pow2 to
+   // 7e-5 (relative), and fast_sin to 4e-5.
+   //
+   // The arguments are clamped to the ranges above, e.g. poly_exp(-100)
+   // is about 1e-38 (FLT_MIN) instead of a denormal, and poly_log2 of 0 or
+   // of a negative number is -126 (log2(FLT_MIN)). sin and cos reduce x
+   // to one cycle in float, so the error grows with |x|.
+   //
+   // Throughput (ns per sample, blocks of 1024, GCC 12 -O3, x86-64):
+   //
+   //             std::    fast_    SSE2     AVX2     AVX-512
+   //    exp      3.7      3.1      1.56     1.05     0.45
+   //    log2     4.0      0.56     2.0      1.23     0.59
+   //    sin      4.3      0.58     0.91     0.68     0.27
+   //    tanh     14.3     0.30     3.1      2.0      0.82
+   //    db2a     7.0      2.3      1.55     1.05     0.43
+   //    a2db     7.5      0.64     2.0      1.38     0.59
+   //
+   // SSE2, AVX2 and AVX-512 are the runtime dispatched clones (without
+   // FMA). With -O2, the times are within 10-20% of the -O3 times.
+   //
+   // std:: is std::exp, std::log2, std::sin, std::tanh, std::pow(10, x/20)
+   // and 20 * std::log10. fast_ is fast_pow2(x * log2(e)), fast_log2,
+   // fast_sin, fast_rational_tanh (|x| <= 3 only), detail::db2a (table
+   // lookup) and 20 * fast_log10, with SSE2. fast_log2, fast_sin and
+   // fast_rational_tanh are also vectorized, but are less accurate.
+   ////////////////////////////////////////////////////////////////////////////
+   float             poly_pow2(float x);
+   float             poly_exp(float x);
+   float             poly_log2(float x);
+   float             poly_log10(float x);
+   float             poly_sin(float x);
+   float             poly_cos(float x);
+   float             poly_tanh(float x);
+   float             poly_db2a(float db);
+   float             poly_a2db(float a);
+
+   namespace block
+   {
+      void           pow2(float const* in, float* out, std::size_t n);
+      void           exp(float const* in, float* out, std::size_t n);
+      void           log2(float const* in, float* out, std::size_t n);
+      void           log10(float const* in, float* out, std::size_t n);
+      void           sin(float const* in, float* out, std::size_t n);
+      void           cos(float const* in, float* out, std::size_t n);
+      void           tanh(float const* in, float* out, std::size_t n);
+      void           db2a(float const* in, float* out, std::size_t n);
+      void           a2db(float const* in, float* out, std::size_t n);
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   namespace detail
+   {
+      inline std::int32_t float_bits(float x)
+      {
+         std::int32_t i;
+         std::memcpy(&i, &x, sizeof(i));
+         return i;
+      }
+
+      inline float bits_float(std::int32_t i)
+      {
+         float x;
+         std::memcpy(&x, &i, sizeof(x));
+         return x;
+      }
+
+      // c? a : b, as a bitwise select. GCC does not vectorize min, max or
+      // ?: with a constant operand followed by arithmetic (without
+      // -ffast-math), but vectorizes this.
+      inline float select(bool c, float a, float b)
+      {
+         auto mask = -std::int32_t(c);
+         return bits_float((float_bits(a) & mask) | (float_bits(b) & ~mask));
+      }
+
+      inline float clamp(float x, float lo, float hi)
+      {
+         x = select(x < lo, lo, x);
+         return select(x > hi, hi, x);
+      }
+
+      // Round to the nearest integer, |x| < 2^22
+      inline float round_int(float x)
+      {
+         constexpr float magic = 12582912.0f;   // 1.5 * 2^23
+         return (x + magic) - magic;
+      }
+
+      // e^r, for r in [-ln(2)/2, ln(2)/2] (Cephes expf)
+      inline float exp_reduced(float r)
+      {
+         float p = 1.9875691500e-4f;
+         p = p * r + 1.3981999507e-3f;
+         p = p * r + 8.3334519073e-3f;
+         p = p * r + 4.1665795894e-2f;
+         p = p * r + 1.6666665459e-1f;
+         p = p * r + 5.0000001201e-1f;
+         return 1.0f + r + r * r * p;
+      }
+
+      // 2^n, for integer n in [-126, 127]
+      inline float pow2_int(float n)
+      {
+         return bits_float((std::int32_t(n) + 127) << 23);
+      }
+
+      // ln(x) = e * ln(2) + ln(m), for normal x > 0. Returns e and ln(m),
+      // with m in [sqrt(0.5), sqrt(2)) (Cephes logf).
+      inline float log_reduced(float x, float& e)
+      {
+         constexpr float min_normal = 1.17549435e-38f;   // FLT_MIN
+         auto bits = float_bits(select(x < min_normal, min_normal, x));
+         auto m = bits_float((bits & 0x007fffff) | 0x3f800000);  // [1, 2)
+         auto big = m > 1.41421356f;
+         e = float((bits >> 23) - 127 + big);
+         m = select(big, m * 0.5f, m);
+
+         float t = m - 1.0f;
+         float z = t * t;
+         float p = 7.0376836292e-2f;
+         p = p * t - 1.1514610310e-1f;
+         p = p * t + 1.1676998740e-1f;
+         p = p * t - 1.2420140846e-1f;
+         p = p * t + 1.4249322787e-1f;
+         p = p * t - 1.6668057665e-1f;
+         p = p * t + 2.0000714765e-1f;
+         p = p * t - 2.4999993993e-1f;
+         p = p * t + 3.3333331174e-1f;
+         return t + (t * z * p - 0.5f * z);
+      }
+
+      // The samples are processed in fixed size chunks, computed into a
+      // local buffer, then copied to out. With a constant trip count and
+      // no possible aliasing, the loop is vectorized even with GCC's -O2
+      // (very cheap) cost model, which does not allow alias checks or a
+      // scalar epilogue. The remaining samples are computed one at a time.
+      template <typename F>
+      CYCFI_Q_BLOCK_MATH_INLINE void transform(float const* in, float* out, std::size_t n, F f)
+      {
+         constexpr std::size_t chunk_size = 32;
+         std::size_t i = 0;
+         for (; i + chunk_size <= n; i += chunk_size)
+         {
+            float y[chunk_size];
+            for (std::size_t j = 0; j != chunk_size; ++j)
+               y[j] = f(in[i+j]);
+            std::copy_n(y, chunk_size, out + i);
+         }
+         for (; i != n; ++i)
+            out[i] = f(in[i]);
+      }
+   }
+
+   inline float poly_pow2(float x)
+   {
+      x = detail::clamp(x, -126.0f, 127.0f);
+      auto n = detail::round_int(x);
+      return detail::exp_reduced((x - n) * 0.693147181f) * detail::pow2_int(n);
+   }
+
+   inline float poly_exp(float x)
+   {
+      x = detail::clamp(x, -87.0f, 88.0f);
+      auto n = detail::round_int(x * 1.44269504f);
+
+      // x - n ln(2), with ln(2) split in two for precision
+      auto r = x - n * 0.693359375f + n * 2.12194440e-4f;
+      return detail::exp_reduced(r) * detail::pow2_int(n);
+   }
+
+   inline float poly_log2(float x)
+   {
+      float e;
+      auto ln_m = detail::log_reduced(x, e);
+      return ln_m * 1.44269504f + e;
+   }
+
+   inline float poly_log10(float x)
+   {
+      float e;
+      auto ln_m = detail::log_reduced(x, e);
+      return ln_m * 0.434294482f + e * 0.301029996f;
+   }
+
+   inline float poly_sin(float x)
+   {
+      auto c = x * float(1.0 / (2 * pi));
+      return poly_sin_2pi(c - detail::round_int(c));
+   }
+
+   inline float poly_cos(float x)
+   {
+      auto c = x * float(1.0 / (2 * pi)) + 0.25f;
+      return poly_sin_2pi(c - detail::round_int(c));
+   }
+
+   inline float poly_tanh(float x)
+   {
+      // Small x: odd polynomial (Cephes tanhf)
+      float z = x * x;
+      float p = -5.70498872745e-3f;
+      p = p * z + 2.06390887954e-2f;
+      p = p * z - 5.37397155531e-2f;
+      p = p * z + 1.33314422036e-1f;
+      p = p * z - 3.33332819422e-1f;
+      float small = x + x * z * p;
+
+      // Large x: 1 - 2 / (e^2|x| + 1), saturating at 1
+      float a = std::abs(x);
+      float e = poly_exp(2.0f * detail::select(a > 10.0f, 10.0f, a));
+      float large = 1.0f - 2.0f / (e + 1.0f);
+      return detail::select(a < 0.625f, small, std::copysign(large, x));
+   }
+
+   inline float poly_db2a(float db)
+   {
+      return poly_pow2(db * 0.166096405f);     // log2(10) / 20
+   }
+
+   inline float poly_a2db(float a)
+   {
+      float e;
+      auto ln_m = detail::log_reduced(a, e);
+      return ln_m * 8.68588964f + e * 6.02059991f;   // 20 / ln(10), 20 log10(2)
+   }
+
+   namespace block
+   {
+      CYCFI_Q_BLOCK_MATH_DISPATCH
+      inline void pow2(float const* in, float* out, std::size_t n)
+      {
+         detail::transform(in, out, n, [](float x) { return poly_pow2(x); });
+      }
+
+      CYCFI_Q_BLOCK_MATH_DISPATCH
+      inline void exp(float const* in, float* out, std::size_t n)
+      {
+         detail::transform(in, out, n, [](float x) { return poly_exp(x); });
+      }
+
+      CYCFI_Q_BLOCK_MATH_DISPATCH
+      inline void log2(float const* in, float* out, std::size_t n)
+      {
+         detail::transform(in, out, n, [](float x) { return poly_log2(x); });
+      }
+
+      CYCFI_Q_BLOCK_MATH_DISPATCH
+      inline void log10(float const* in, float* out, std::size_t n)
+      {
+         detail::transform(in, out, n, [](float x) { return poly_log10(x); });
+      }
+
+      CYCFI_Q_BLOCK_MATH_DISPATCH
+      inline void sin(float const* in, float* out, std::size_t n)
+      {
+         detail::transform(in, out, n, [](float x) { return poly_sin(x); });
+      }
+
+      CYCFI_Q_BLOCK_MATH_DISPATCH
+      inline void cos(float const* in, float* out, std::size_t n)
+      {
+         detail::transform(in, out, n, [](float x) { return poly_cos(x); });
+      }
+
+      CYCFI_Q_BLOCK_MATH_DISPATCH
+      inline void tanh(float const* in, float* out, std::size_t n)
+      {
+         detail::transform(in, out, n, [](float x) { return poly_tanh(x); });
+      }
+
+      CYCFI_Q_BLOCK_MATH_DISPATCH
+      inline void db2a(float const* in, float* out, std::size_t n)
+      {
+         detail::transform(in, out, n, [](float x) { return poly_db2a(x); });
+      }
+
+      CYCFI_Q_BLOCK_MATH_DISPATCH
+      inline void a2db(float const* in, float* out, std::size_t n)
+      {
+         detail::transform(in, out, n, [](float x) { return poly_a2db(x); });
+      }
+   }
+}
+
+#endif
@@ -7,7 +7,9 @@
 #define CYCFI_Q_DECIBEL_HPP_FEBRUARY_21_2018
 
 #include <cmath>
+#include <cstddef>
 #include <q/detail/db_table.hpp>
+#include <q/support/block_math.hpp>
 
 namespace cycfi::q
 {
@@ -67,6 +69,23 @@ namespace cycfi::q
    constexpr bool    operator>(decibel a, decibel b);
    constexpr bool    operator>=(decibel a, decibel b);
 
+   ////////////////////////////////////////////////////////////////////////////
+   // Float-native decibel conversions. The dB values are plain floats.
+   // Unlike decibel(val) and as_float(db), which use fast_log10 and a
+   // lookup table limited to +-120 dB, these are branch-free (poly_a2db and
+   // poly_db2a in block_math.hpp), accurate to float precision, and cover
+   // the full float range: to_db(a) is -758.6 dB for a = FLT_MIN (and for
+   // 0), and from_db(db) is clamped to [-758.6, 764.5] dB.
+   //
+   // The block versions vectorize, so they are best for converting
+   // envelopes and gains in block processing (e.g. envelope followers and
+   // compressors). in and out may be the same array.
+   ////////////////////////////////////////////////////////////////////////////
+   float             to_db(float a);
+   float             from_db(float db);
+   void              to_db(float const* in, float* out, std::size_t n);
+   void              from_db(float const* in, float* out, std::size_t n);
+
    ////////////////////////////////////////////////////////////////////////////
    // Inlines
    ////////////////////////////////////////////////////////////////////////////
@@ -183,6 +202,26 @@ namespace cycfi::q
    {
       return a.rep >= b.rep;
    }
+
+   inline float to_db(float a)
+   {
+      return poly_a2db(a);
+   }
+
+   inline float from_db(float db)
+   {
+      return poly_db2a(db);
+   }
+
+   inline void to_db(float const* in, float* out, std::size_t n)
+   {
+      block::a2db(in, out, n);
+   }
+
+   inline void from_db(float const* in, float* out, std::size_t n)
+   {
+      block::db2a(in, out, n);
+   }
 }
 
 #endif
@@ -0,0 +1,235 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_ADDITIVE_SYNTH_OCTOBER_19_2026)
+#define CYCFI_Q_ADDITIVE_SYNTH_OCTOBER_19_2026
+
+#include <q/support/literals.hpp>
+#include <q/detail/bank_base.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // additive_synth: An additive synthesizer voice, given N partials (sine
+   // waves), each with its own frequency and amplitude. The output is the
+   // sum of the partials:
+   //
+   //    y = sum(amplitude[k] * sin(phase[k]))
+   //
+   // Each partial is a quadrature oscillator, rotated by its phase
+   // increment every sample, with periodic renormalization (the same
+   // recurrence as sin_cos_gen_bank). The partials are kept in SoA
+   // (structure of arrays) layout and rendered in a branch-free loop
+   // across the partials that the compiler can vectorize, with the sum
+   // accumulated in group_size partial sums.
+   //
+   // The frequencies and amplitudes are updated per block: set them
+   // before calling render. The amplitudes are interpolated linearly over
+   // the block, from the previous block's amplitudes, so there are no
+   // clicks. Frequency changes take effect at the start of the block and
+   // keep the partial's phase, so they are continuous. The rotations of
+   // all the partials are recomputed when any frequency changes, using
+   // poly_sin_2pi, which vectorizes. Use harmonics(f0) to set the
+   // partials to the harmonic series of f0.
+   //
+   // Partials at or above Nyquist (sps/2) are culled: they are silenced
+   // immediately (they would alias) and are not rendered. Only the groups
+   // of group_size partials up to the highest audible partial with a
+   // nonzero amplitude are rendered. Thus, for harmonic spectra, the cost
+   // drops with the pitch (e.g. only 24 of 256 harmonics of 1 kHz are
+   // below Nyquist at 48 kHz).
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   class additive_synth
+   {
+   public:
+
+      static constexpr std::size_t num_partials = N;
+      static constexpr std::size_t group_size = 8;
+      static constexpr std::size_t renormalize_interval = 32;
+
+      static_assert(N % group_size == 0,
+         "Error: The number of partials must be a multiple of group_size");
+
+      explicit                additive_synth(float sps);
+
+      void                    render(float* out, std::size_t n);
+
+      void                    partial_frequency(std::size_t k, frequency f);
+      void                    partial_amplitude(std::size_t k, float amplitude);
+      void                    harmonics(frequency f0);
+      void                    reset();
+
+      std::size_t             active_partials() const;
+
+   private:
+
+      void                    update_rotations();
+      bool                    audible(std::size_t k) const;
+
+      float                   _sps;
+      frame<N>                _sin, _cos;       // Oscillator state
+      frame<N>                _sin_w, _cos_w;   // Rotation per sample
+      frame<N>                _freq;            // Frequency, in cycles per sample
+      frame<N>                _amp;             // Target amplitude
+      frame<N>                _gain;            // Current amplitude
+      std::size_t             _count = 0;       // Samples since renormalize
+      bool                    _update = true;   // The frequencies changed
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   inline additive_synth<N>::additive_synth(float sps)
+    : _sps(sps)
+   {
+      _freq.fill(0.0f);
+      _amp.fill(0.0f);
+      reset();
+   }
+
+   template <std::size_t N>
+   inline void additive_synth<N>::partial_frequency(std::size_t k, frequency f)
+   {
+      _freq[k] = as_double(f) / _sps;
+      _update = true;
+   }
+
+   template <std::size_t N>
+   inline void additive_synth<N>::partial_amplitude(std::size_t k, float amplitude)
+   {
+      _amp[k] = amplitude;
+   }
+
+   // Set partial k to the (k+1)th harmonic of f0
+   template <std::size_t N>
+   inline void additive_synth<N>::harmonics(frequency f0)
+   {
+      auto f = as_double(f0) / _sps;
+      for (std::size_t k = 0; k != N; ++k)
+         _freq[k] = f * (k + 1);
+      _update = true;
+   }
+
+   // Reset the phases of all partials to 0, and silence them immediately.
+   // The amplitudes of the next block ramp up from 0.
+   template <std::size_t N>
+   inline void additive_synth<N>::reset()
+   {
+      _sin.fill(0.0f);
+      _cos.fill(1.0f);
+      _gain.fill(0.0f);
+      _count = 0;
+   }
+
+   template <std::size_t N>
+   inline void additive_synth<N>::update_rotations()
+   {
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         auto x = std::min(std::abs(_freq[k]), 0.5f);
+         _sin_w[k] = std::copysign(poly_sin_2pi(x), _freq[k]);
+         _cos_w[k] = poly_sin_2pi(0.25f - x);
+      }
+      _update = false;
+   }
+
+   // Partials at or above Nyquist are culled
+   template <std::size_t N>
+   inline bool additive_synth<N>::audible(std::size_t k) const
+   {
+      return std::abs(_freq[k]) < 0.5f;
+   }
+
+   // The number of partials rendered in the next block: up to the highest
+   // audible partial with a nonzero amplitude, rounded up to group_size
+   template <std::size_t N>
+   inline std::size_t additive_synth<N>::active_partials() const
+   {
+      for (std::size_t k = N; k != 0; --k)
+      {
+         if (audible(k-1) && (_amp[k-1] != 0.0f || _gain[k-1] != 0.0f))
+            return (k + group_size - 1) & ~(group_size - 1);
+      }
+      return 0;
+   }
+
+   template <std::size_t N>
+   inline void additive_synth<N>::render(float* out, std::size_t n)
+   {
+      if (n == 0)
+         return;
+      if (_update)
+         update_rotations();
+
+      // Silence the culled partials immediately, and ramp the others to
+      // their target amplitudes over the block
+      frame<N> step;
+      auto const ramp = 1.0f / n;
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         float on = audible(k);
+         _gain[k] *= on;
+         step[k] = (_amp[k] * on - _gain[k]) * ramp;
+      }
+
+      auto const lanes = active_partials();
+      if (lanes == 0)
+      {
+         std::fill_n(out, n, 0.0f);
+         return;
+      }
+
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         if (_count == renormalize_interval)
+         {
+            for (std::size_t k = 0; k != lanes; ++k)
+            {
+               auto g = 1.5f - 0.5f * (_sin[k] * _sin[k] + _cos[k] * _cos[k]);
+               _sin[k] *= g;
+               _cos[k] *= g;
+            }
+            _count = 0;
+         }
+         ++_count;
+
+         // The partials and their sum are computed in separate loops, so
+         // that both vectorize
+         frame<N> y;
+         for (std::size_t k = 0; k != lanes; ++k)
+         {
+            auto s = _sin[k];
+            auto c = _cos[k];
+            _cos[k] = c * _cos_w[k] - s * _sin_w[k];
+            _sin[k] = s * _cos_w[k] + c * _sin_w[k];
+            _gain[k] += step[k];
+            y[k] = _gain[k] * _sin[k];
+         }
+
+         float acc[group_size] = {};
+         for (std::size_t first = 0; first != lanes; first += group_size)
+         {
+            for (std::size_t j = 0; j != group_size; ++j)
+               acc[j] += y[first + j];
+         }
+
+         float sum = 0.0f;
+         for (std::size_t j = 0; j != group_size; ++j)
+            sum += acc[j];
+         out[i] = sum;
+      }
+
+      // Land exactly on the target amplitudes
+      for (std::size_t k = 0; k != N; ++k)
+         _gain[k] = _amp[k] * audible(k);
+   }
+}
+
+#endif
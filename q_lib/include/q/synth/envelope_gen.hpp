@@ -8,6 +8,8 @@
 
 #include <q/support/literals.hpp>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace cycfi::q
 {
@@ -17,6 +19,18 @@ namespace cycfi::q
    // shape. The trigger member functions start the attack. The envelope can
    // be retriggered multiple times. The release member function starts the
    // release.
+   //
+   // Block rendering is available via render(out, n). Each segment
+   // (attack, decay, sustain, release) is an exponential approach to a
+   // target, so the number of samples up to the next state transition is
+   // computed in closed form, and the segment is filled without the
+   // per-sample state checks, in a loop that the compiler can vectorize.
+   // The transitions are then handled once per segment, by the per-sample
+   // update. The output matches the per-sample envelope within float
+   // rounding, except that the transitions may be a few samples apart.
+   // (The closed form is the more accurate of the two in slow segments,
+   // such as the sustain, where the per-sample rate is within a few ulps
+   // of 1.)
    ////////////////////////////////////////////////////////////////////////////
    class envelope_gen
    {
@@ -50,6 +64,7 @@ namespace cycfi::q
                               envelope_gen(float sps);
 
       float                   operator()();
+      void                    render(float* out, std::size_t n);
       float                   current() const { return _y; }
       void                    trigger(float level, int auto_decay = 1);
       void                    legato();
@@ -178,6 +193,126 @@ namespace cycfi::q
       return _y;
    }
 
+   namespace detail
+   {
+      // Returns the number of samples, k >= 1, up to and including the
+      // first sample where d * rate^k < e, where d is the distance of the
+      // envelope from its target, and e is the distance of the state
+      // transition threshold from the target. Returns the maximum
+      // std::size_t if there is no such sample.
+      inline std::size_t envelope_segment_length(float d, float e, float rate)
+      {
+         constexpr auto never = std::numeric_limits<std::size_t>::max();
+         if (d * rate < e)
+            return 1;
+         if (!(rate > 0.0f && rate < 1.0f) || e <= 0.0f)
+            return never;
+         auto k = std::floor(std::log(double(e) / d) / std::log(double(rate))) + 1;
+         return (k < double(never))? std::max(std::size_t(k), std::size_t(1)) : never;
+      }
+
+      // Fill out[0..n) with the exponential approach to the target, given
+      // the distance d from the target: out[i] = target + d * rate^(i+1).
+      // The powers of the rate are computed in strides of 8 samples, so
+      // there is no serial dependency from one sample to the next.
+      inline void envelope_fill(
+         float* out, std::size_t n, float target, float d, float rate)
+      {
+         float p[8];
+         p[0] = rate;
+         for (std::size_t l = 1; l != 8; ++l)
+            p[l] = p[l-1] * rate;
+         auto const rate8 = p[7];
+
+         std::size_t i = 0;
+         for (; i + 8 <= n; i += 8, d *= rate8)
+         {
+            for (std::size_t l = 0; l != 8; ++l)
+               out[i + l] = target + d * p[l];
+         }
+         for (std::size_t l = 0; l != n - i; ++l)
+            out[i + l] = target + d * p[l];
+      }
+   }
+
+   inline void envelope_gen::render(float* out, std::size_t n)
+   {
+      while (n != 0)
+      {
+         // The segment's target and rate, and the length of the segment
+         // up to (and including) the state transition
+         float target, rate;
+         std::size_t length;
+         switch (_state)
+         {
+            case note_off_state:
+               std::fill_n(out, n, 0.0f);
+               return;
+
+            case legato_state:
+               target = _legato_level;
+               rate = _attack_rate;
+               length = detail::envelope_segment_length(_y - target, hysteresis, rate);
+               break;
+
+            case attack_state:
+               // Without auto decay, the envelope stays at the level
+               if (_auto_decay == 0 && _y == _level)
+               {
+                  std::fill_n(out, n, _y);
+                  return;
+               }
+               target = 1.6f;
+               rate = _attack_rate;
+               length = detail::envelope_segment_length(target - _y, target - _level, rate);
+               break;
+
+            case decay_state:
+               target = _level * _sustain_level;
+               rate = _decay_rate;
+               length = detail::envelope_segment_length(_y - target, hysteresis, rate);
+               break;
+
+            case sustain_state:
+               detail::envelope_fill(out, n, 0.0f, _y, _sustain_rate);
+               _y = out[n-1];
+               return;
+
+            case note_release_state:
+            case release_state:
+            default:
+               // The envelope stays at the note off level, if any
+               if (_y == _note_off_level && _note_off_level >= hysteresis)
+               {
+                  std::fill_n(out, n, _y);
+                  return;
+               }
+               target = _note_off_level;
+               rate = _release_rate;
+               length = detail::envelope_segment_length(_y - target, hysteresis, rate);
+               break;
+         }
+
+         if (length > n)
+         {
+            detail::envelope_fill(out, n, target, _y - target, rate);
+            _y = out[n-1];
+            return;
+         }
+
+         // Fill the segment, then let the per-sample update do the state
+         // transition on its last sample.
+         if (length > 1)
+         {
+            detail::envelope_fill(out, length - 1, target, _y - target, rate);
+            _y = out[length - 2];
+         }
+         out[length - 1] = (*this)();
+         out += length;
+         n -= length;
+      }
+   }
+
    inline void envelope_gen::trigger(float level, int auto_decay)
    {
       if (_y < level)
@@ -0,0 +1,259 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_ENVELOPE_GEN_BANK_OCTOBER_19_2026)
+#define CYCFI_Q_ENVELOPE_GEN_BANK_OCTOBER_19_2026
+
+#include <q/support/literals.hpp>
+#include <q/synth/envelope_gen.hpp>
+#include <q/detail/bank_base.hpp>
+#include <array>
+#include <cstdint>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // envelope_gen_bank: N ADSR envelopes (lanes), e.g. one per voice of a
+   // polyphonic synth, sharing one envelope_gen::config.
+   //
+   // The envelopes follow the attack, decay, sustain and release curves of
+   // envelope_gen (legato is not supported). Each state is an exponential
+   // approach, y = target + rate * (y - target), followed by a check for
+   // the state transition threshold. The state is kept in SoA (structure
+   // of arrays) layout and the lanes are updated in groups of group_size,
+   // in branch-free loops that the compiler can vectorize. The rare state
+   // transitions are handled outside the vectorized loop.
+   //
+   // trigger(k, level) starts the attack of lane k. If the lane's level is
+   // already higher than the new level, the decay to the new sustain level
+   // starts instead. release(k) starts the release. The lane is off when
+   // the release is done.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   class envelope_gen_bank
+   {
+   public:
+
+      static constexpr std::size_t group_size = 8;
+      static constexpr std::size_t num_lanes = N;
+      static constexpr std::size_t num_groups = N / group_size;
+
+      static_assert(N % group_size == 0, "Error: N must be a multiple of group_size");
+
+      using state_enum = envelope_gen::state_enum;
+
+                              envelope_gen_bank(envelope_gen::config const& config_, float sps);
+
+      void                    config(envelope_gen::config const& config_, float sps);
+      bool                    update(std::size_t g);
+      bool                    update_lanes(std::size_t n);
+      frame<N> const&         levels() const          { return _y; }
+
+      void                    trigger(std::size_t k, float level);
+      void                    release(std::size_t k);
+      void                    reset(std::size_t k);
+
+      state_enum              state(std::size_t k) const    { return _state[k]; }
+      float                   current(std::size_t k) const  { return _y[k]; }
+      float                   velocity(std::size_t k) const { return _level[k]; }
+      bool                    active(std::size_t k) const;
+
+   private:
+
+      void                    set_state(std::size_t k, state_enum state);
+      bool                    update_states(std::size_t g);
+
+      // Envelope rates
+      float                   _attack_rate;
+      float                   _decay_rate;
+      float                   _sustain_level;
+      float                   _sustain_rate;
+      float                   _release_rate;
+
+      // Lane state (SoA)
+      frame<N>                _y;         // envelope level
+      frame<N>                _target;    // envelope target
+      frame<N>                _rate;      // envelope rate
+      frame<N>                _limit;     // state transition threshold
+      frame<N>                _dir;       // +1: rising, -1: falling
+      frame<N>                _level;     // velocity
+      std::array<state_enum, N> _state;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   inline envelope_gen_bank<N>::envelope_gen_bank(
+      envelope_gen::config const& config_, float sps)
+   {
+      config(config_, sps);
+      _y.fill(0.0f);
+      _level.fill(0.0f);
+      for (std::size_t k = 0; k != N; ++k)
+         set_state(k, envelope_gen::note_off_state);
+   }
+
+   // Set the envelope rates. Lanes that are already in a state keep the
+   // rate of that state until the next transition.
+   template <std::size_t N>
+   inline void envelope_gen_bank<N>::config(
+      envelope_gen::config const& config_, float sps)
+   {
+      _attack_rate = fast_exp3(-2.0f / (sps * as_double(config_.attack_rate)));
+      _decay_rate = fast_exp3(-2.0f / (sps * as_double(config_.decay_rate)));
+      _sustain_level = as_float(config_.sustain_level);
+      _sustain_rate = fast_exp3(-2.0f / (sps * as_double(config_.sustain_rate)));
+      _release_rate = fast_exp3(-2.0f / (sps * as_double(config_.release_rate)));
+   }
+
+   // Set the state of lane k, with its envelope target, rate and
+   // transition threshold.
+   template <std::size_t N>
+   inline void envelope_gen_bank<N>::set_state(std::size_t k, state_enum state)
+   {
+      constexpr auto hysteresis = envelope_gen::hysteresis;
+      _state[k] = state;
+      switch (state)
+      {
+         case envelope_gen::attack_state:
+            _target[k] = 1.6f;
+            _rate[k] = _attack_rate;
+            _limit[k] = _level[k];
+            _dir[k] = 1.0f;
+            break;
+
+         case envelope_gen::decay_state:
+            _target[k] = _level[k] * _sustain_level;
+            _rate[k] = _decay_rate;
+            _limit[k] = _target[k] + hysteresis;
+            _dir[k] = -1.0f;
+            break;
+
+         case envelope_gen::sustain_state:
+            _target[k] = 0.0f;
+            _rate[k] = _sustain_rate;
+            _limit[k] = -1.0f;   // never
+            _dir[k] = -1.0f;
+            break;
+
+         case envelope_gen::release_state:
+            _target[k] = 0.0f;
+            _rate[k] = _release_rate;
+            _limit[k] = hysteresis;
+            _dir[k] = -1.0f;
+            break;
+
+         default:
+            _state[k] = envelope_gen::note_off_state;
+            _y[k] = _target[k] = _rate[k] = 0.0f;
+            _limit[k] = -1.0f;   // never
+            _dir[k] = -1.0f;
+            break;
+      }
+   }
+
+   // Update the lanes of group g by one sample. Returns true if a lane
+   // turned off.
+   template <std::size_t N>
+   inline bool envelope_gen_bank<N>::update(std::size_t g)
+   {
+      auto const base = g * group_size;
+      int transition = 0;
+      for (std::size_t l = 0; l != group_size; ++l)
+      {
+         auto k = base + l;
+         _y[k] = _target[k] + _rate[k] * (_y[k] - _target[k]);
+         transition |= (_y[k] - _limit[k]) * _dir[k] > 0.0f;
+      }
+      return transition? update_states(g) : false;
+   }
+
+   // Update lanes 0 to n-1 by one sample, where n is a multiple of
+   // group_size. Returns true if a lane turned off. The loop has a runtime
+   // trip count, which the compiler vectorizes better than the fixed
+   // group_size loops when many lanes are updated at once.
+   template <std::size_t N>
+   inline bool envelope_gen_bank<N>::update_lanes(std::size_t n)
+   {
+      int transition = 0;
+      for (std::size_t k = 0; k < n; ++k)
+      {
+         _y[k] = _target[k] + _rate[k] * (_y[k] - _target[k]);
+         transition |= (_y[k] - _limit[k]) * _dir[k] > 0.0f;
+      }
+      if (!transition)
+         return false;
+
+      bool lane_off = false;
+      for (std::size_t g = 0; g < n / group_size; ++g)
+         lane_off |= update_states(g);
+      return lane_off;
+   }
+
+   // Handle the state transitions of group g
+   template <std::size_t N>
+   inline bool envelope_gen_bank<N>::update_states(std::size_t g)
+   {
+      bool lane_off = false;
+      for (auto k = g * group_size; k != (g + 1) * group_size; ++k)
+      {
+         if ((_y[k] - _limit[k]) * _dir[k] <= 0.0f)
+            continue;
+
+         switch (_state[k])
+         {
+            case envelope_gen::attack_state:
+               _y[k] = _level[k];
+               set_state(k, envelope_gen::decay_state);
+               break;
+
+            case envelope_gen::decay_state:
+               _y[k] = _target[k];
+               set_state(k, envelope_gen::sustain_state);
+               break;
+
+            case envelope_gen::release_state:
+               set_state(k, envelope_gen::note_off_state);
+               lane_off = true;
+               break;
+
+            default:
+               break;
+         }
+      }
+      return lane_off;
+   }
+
+   template <std::size_t N>
+   inline void envelope_gen_bank<N>::trigger(std::size_t k, float level)
+   {
+      _level[k] = level;
+      set_state(k, (_y[k] < level)?
+         envelope_gen::attack_state : envelope_gen::decay_state);
+   }
+
+   template <std::size_t N>
+   inline void envelope_gen_bank<N>::release(std::size_t k)
+   {
+      if (active(k) && _state[k] != envelope_gen::release_state)
+         set_state(k, envelope_gen::release_state);
+   }
+
+   // Turn lane k off immediately
+   template <std::size_t N>
+   inline void envelope_gen_bank<N>::reset(std::size_t k)
+   {
+      set_state(k, envelope_gen::note_off_state);
+   }
+
+   template <std::size_t N>
+   inline bool envelope_gen_bank<N>::active(std::size_t k) const
+   {
+      return _state[k] != envelope_gen::note_off_state;
+   }
+}
+
+#endif
@@ -0,0 +1,536 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_FM_SYNTH_OCTOBER_19_2026)
+#define CYCFI_Q_FM_SYNTH_OCTOBER_19_2026
+
+#include <q/support/literals.hpp>
+#include <q/support/phase.hpp>
+#include <q/support/midi.hpp>
+#include <q/synth/envelope_gen_bank.hpp>
+#include <q/synth/poly_synth.hpp>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // fm_algorithm: The routing of an FM (phase modulation) operator
+   // network, given a bit mask of the carriers (the operators that are
+   // heard), followed by one bit mask per operator of the operators that
+   // modulate it. Bit k is operator k.
+   //
+   // An operator may only be modulated by operators with higher indices,
+   // which are computed first. An operator may modulate itself (the bit of
+   // its own index), which is the operator's feedback.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::uint32_t Carriers, std::uint32_t... Modulators>
+   struct fm_algorithm
+   {
+      static constexpr std::size_t num_operators = sizeof...(Modulators);
+      static constexpr std::uint32_t carriers = Carriers;
+      static constexpr std::uint32_t modulators[] = { Modulators... };
+
+      static constexpr bool is_valid()
+      {
+         constexpr std::uint32_t all = (std::uint64_t{1} << num_operators) - 1;
+         if (carriers == 0 || (carriers & ~all) != 0)
+            return false;
+         for (std::size_t k = 0; k != num_operators; ++k)
+         {
+            auto below = (std::uint32_t{1} << k) - 1;
+            if ((modulators[k] & ~all) != 0 || (modulators[k] & below) != 0)
+               return false;
+         }
+         return true;
+      }
+
+      static_assert(num_operators >= 1 && num_operators <= 16,
+         "Error: fm_algorithm must have 1 to 16 operators");
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // The 8 classic 4 operator algorithms. Operator 0 is the bottom
+   // operator and operator 3, the top operator, has feedback. In the
+   // diagrams, a -> b means a modulates b, and (a b) are carriers.
+   ////////////////////////////////////////////////////////////////////////////
+   namespace fm4
+   {
+      // 3 -> 2 -> 1 -> (0)
+      using algorithm_1 = fm_algorithm<0b0001, 0b0010, 0b0100, 0b1000, 0b1000>;
+
+      // (3 + 2) -> 1 -> (0)
+      using algorithm_2 = fm_algorithm<0b0001, 0b0010, 0b1100, 0b0000, 0b1000>;
+
+      // (1 + (3 -> 2)) -> (0)
+      using algorithm_3 = fm_algorithm<0b0001, 0b0110, 0b0000, 0b1000, 0b1000>;
+
+      // ((3 -> 1) + 2) -> (0)
+      using algorithm_4 = fm_algorithm<0b0001, 0b0110, 0b1000, 0b0000, 0b1000>;
+
+      // 1 -> (0), 3 -> (2)
+      using algorithm_5 = fm_algorithm<0b0101, 0b0010, 0b0000, 0b1000, 0b1000>;
+
+      // 3 -> (0 1 2)
+      using algorithm_6 = fm_algorithm<0b0111, 0b1000, 0b1000, 0b1000, 0b1000>;
+
+      // 3 -> (2), (0 1)
+      using algorithm_7 = fm_algorithm<0b0111, 0b0000, 0b0000, 0b1000, 0b1000>;
+
+      // (0 1 2 3)
+      using algorithm_8 = fm_algorithm<0b1111, 0b0000, 0b0000, 0b0000, 0b1000>;
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // fm_synth: an N voice polyphonic FM (phase modulation) synthesizer,
+   // given an fm_algorithm. Each operator is a sine oscillator at a
+   // ratio of the note frequency, with its own ADSR envelope
+   // (envelope_gen::config), output level and feedback:
+   //
+   //    y = sin(phase + modulation) * envelope * level
+   //
+   // The modulation is the sum of the outputs of the operator's
+   // modulators, in radians. Thus, a modulator's level is its modulation
+   // index (the peak phase deviation in radians), and a carrier's level is
+   // its amplitude. Feedback is the modulation index of the operator's own
+   // output, averaged over the last two samples (without the level).
+   //
+   // The envelopes are triggered with the note's velocity.
+   //
+   // The voice state is kept in SoA (structure of arrays) layout, with the
+   // envelopes in one envelope_gen_bank per operator. Each sample, the
+   // operators are rendered one at a time, from the top operator down
+   // (unrolled at compile time, following the algorithm), each in a
+   // branch-free loop across the voices that the compiler can vectorize.
+   // The sine is a polynomial (see detail::fm_sin) rather than a table
+   // lookup, which would need gathers. Only the groups of group_size
+   // voices up to the highest active voice are rendered, and new notes
+   // take the lowest free voice.
+   //
+   // A voice is active until all its carrier envelopes are done. Voices
+   // are stolen following a voice_stealing policy (see poly_synth), where
+   // the quietest voice is the one with the lowest carrier envelope
+   // level. A stolen voice continues from its current phases and
+   // envelope levels, without a click.
+   //
+   // Note events are applied immediately, so for sample accurate timing,
+   // split the render calls at the note events.
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename Algorithm, std::size_t N>
+   class fm_synth
+   {
+   public:
+
+      static constexpr std::size_t num_operators = Algorithm::num_operators;
+      static constexpr std::size_t group_size = envelope_gen_bank<N>::group_size;
+      static constexpr std::size_t num_voices = N;
+
+      static_assert(Algorithm::is_valid(), "Error: Invalid fm_algorithm routing");
+
+      struct operator_config
+      {
+         float                ratio = 1.0f;     // Ratio of the note frequency
+         float                level = 1.0f;     // Modulation index or amplitude
+         float                feedback = 0.0f;  // Feedback modulation index
+         envelope_gen::config envelope = {};
+      };
+
+      using config_type = std::array<operator_config, num_operators>;
+
+                           fm_synth(
+                              config_type const& config_
+                            , float sps
+                            , voice_stealing stealing_ = voice_stealing::oldest
+                           );
+
+      void                 render(float* out, std::size_t n);
+
+      void                 note_on(std::uint8_t key, float velocity);
+      void                 note_off(std::uint8_t key);
+      void                 all_notes_off();
+      void                 all_sounds_off();
+
+      void                 config(std::size_t op, operator_config const& config_);
+      operator_config const& config(std::size_t op) const;
+
+      void                 stealing(voice_stealing policy);
+      voice_stealing       stealing() const;
+      std::size_t          active_voices() const;
+
+   private:
+
+      using voice_phases = std::array<std::uint32_t, N>;
+      using outputs = std::array<frame<N>, num_operators>;
+
+      template <std::size_t K>
+      bool                 render_operator(std::size_t lanes, outputs& y);
+
+      template <std::size_t... K>
+      bool                 render_operators(
+                              std::size_t lanes
+                            , outputs& y
+                            , std::index_sequence<K...>
+                           );
+
+      bool                 active(std::size_t v) const;
+      float                carrier_level(std::size_t v) const;
+      std::size_t          allocate();
+      void                 update_groups();
+
+      float                _sps;
+      voice_stealing       _stealing;
+      config_type          _config;
+
+      // Operator and voice state (SoA)
+      std::array<voice_phases, num_operators>         _phase;
+      std::array<voice_phases, num_operators>         _step;
+      std::array<frame<N>, num_operators>             _fb1, _fb2;
+      std::array<envelope_gen_bank<N>, num_operators> _env;
+      std::array<double, N>                           _freq;
+      std::array<std::uint8_t, N>                     _key;
+      std::array<std::uint32_t, N>                    _age;
+
+      std::uint32_t        _clock = 0;
+      std::size_t          _groups = 0;   // groups up to the highest active voice
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   namespace detail
+   {
+      template <std::size_t N, typename Config, std::size_t... K>
+      inline std::array<envelope_gen_bank<N>, sizeof...(K)>
+      make_envelope_gen_banks(
+         Config const& config, float sps, std::index_sequence<K...>)
+      {
+         return { envelope_gen_bank<N>(config[K].envelope, sps)... };
+      }
+
+      // Convert a modulation in radians to a phase offset, wrapped to
+      // (-pi, pi), without branches or calls, so it can be vectorized.
+      inline std::uint32_t fm_phase_offset(float radians)
+      {
+         constexpr float magic = 12582912.0f;   // 1.5 * 2^23, for rounding
+         auto cycles = radians * float(1.0 / (2 * pi));
+         cycles -= (cycles + magic) - magic;    // nearest integer
+         return std::uint32_t(std::int32_t(cycles * 4294967040.0f));
+      }
+
+      // sin of a phase, using a polynomial instead of a table lookup, so
+      // it can be vectorized (no gathers). The phase is mapped to cycles in
+      // [-0.5, 0.5). See poly_sin_2pi (max error about 1e-7, same as the
+      // sin_lu quadrature interpolation).
+      inline float fm_sin(std::uint32_t p)
+      {
+         return poly_sin_2pi(std::int32_t(p) * (1.0f / 4294967296.0f));
+      }
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline fm_synth<Algorithm, N>::fm_synth(
+      config_type const& config_
+    , float sps
+    , voice_stealing stealing_
+   )
+    : _sps(sps)
+    , _stealing(stealing_)
+    , _config(config_)
+    , _env(detail::make_envelope_gen_banks<N>(
+         config_, sps, std::make_index_sequence<num_operators>{}))
+   {
+      for (std::size_t k = 0; k != num_operators; ++k)
+      {
+         _phase[k].fill(0);
+         _step[k].fill(0);
+         _fb1[k].fill(0.0f);
+         _fb2[k].fill(0.0f);
+      }
+      _freq.fill(0.0);
+      _key.fill(0);
+      _age.fill(0);
+   }
+
+   // Render operator K of the first lanes voices for one sample, given
+   // the outputs of the operators above it. Returns true if a carrier
+   // envelope is done.
+   template <typename Algorithm, std::size_t N>
+   template <std::size_t K>
+   inline bool fm_synth<Algorithm, N>::render_operator(
+      std::size_t lanes, outputs& y)
+   {
+      constexpr auto mods = Algorithm::modulators[K];
+      constexpr bool is_carrier = (Algorithm::carriers >> K) & 1;
+      constexpr bool has_feedback = (mods >> K) & 1;
+
+      bool done = _env[K].update_lanes(lanes);
+      auto const& env = _env[K].levels();
+      auto const level = _config[K].level;
+      auto const feedback = _config[K].feedback * 0.5f;
+
+      auto& phase_ = _phase[K];
+      auto const& step = _step[K];
+      auto& fb1 = _fb1[K];
+      auto& fb2 = _fb2[K];
+      auto& out = y[K];
+
+      // Modulation (feedback and modulators)
+      frame<N> m;
+      for (std::size_t v = 0; v < lanes; ++v)
+         m[v] = has_feedback? feedback * (fb1[v] + fb2[v]) : 0.0f;
+      for (std::size_t j = K + 1; j < num_operators; ++j)
+      {
+         if ((mods >> j) & 1)
+         {
+            for (std::size_t v = 0; v < lanes; ++v)
+               m[v] += y[j][v];
+         }
+      }
+
+      // Oscillator
+      for (std::size_t v = 0; v < lanes; ++v)
+      {
+         auto s = detail::fm_sin(phase_[v] + detail::fm_phase_offset(m[v])) * env[v];
+         if constexpr (has_feedback)
+         {
+            fb2[v] = fb1[v];
+            fb1[v] = s;
+         }
+         out[v] = s * level;
+         phase_[v] += step[v];
+      }
+      return is_carrier && done;
+   }
+
+   // Render all the operators, from the top (highest index) to the bottom
+   template <typename Algorithm, std::size_t N>
+   template <std::size_t... K>
+   inline bool fm_synth<Algorithm, N>::render_operators(
+      std::size_t lanes
+    , outputs& y
+    , std::index_sequence<K...>
+   )
+   {
+      bool done = false;
+      ((done |= render_operator<num_operators - 1 - K>(lanes, y)), ...);
+      return done;
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline void fm_synth<Algorithm, N>::render(float* out, std::size_t n)
+   {
+      outputs y;
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         auto const lanes = _groups * group_size;
+         if (render_operators(
+            lanes, y, std::make_index_sequence<num_operators>{}))
+         {
+            update_groups();
+         }
+
+         float sum = 0.0f;
+         for (std::size_t k = 0; k != num_operators; ++k)
+         {
+            if ((Algorithm::carriers >> k) & 1)
+            {
+               for (std::size_t v = 0; v < lanes; ++v)
+                  sum += y[k][v];
+            }
+         }
+         out[i] = sum;
+      }
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline bool fm_synth<Algorithm, N>::active(std::size_t v) const
+   {
+      for (std::size_t k = 0; k != num_operators; ++k)
+      {
+         if (((Algorithm::carriers >> k) & 1) && _env[k].active(v))
+            return true;
+      }
+      return false;
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline float fm_synth<Algorithm, N>::carrier_level(std::size_t v) const
+   {
+      float level = 0.0f;
+      for (std::size_t k = 0; k != num_operators; ++k)
+      {
+         if ((Algorithm::carriers >> k) & 1)
+            level = std::max(level, _env[k].current(v));
+      }
+      return level;
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline void fm_synth<Algorithm, N>::update_groups()
+   {
+      _groups = 0;
+      for (std::size_t v = N; v != 0; --v)
+      {
+         if (active(v-1))
+         {
+            _groups = (v - 1) / group_size + 1;
+            break;
+         }
+      }
+   }
+
+   // Find a voice for a new note: the lowest free voice, or a voice to
+   // steal, according to the voice_stealing policy.
+   template <typename Algorithm, std::size_t N>
+   inline std::size_t fm_synth<Algorithm, N>::allocate()
+   {
+      for (std::size_t v = 0; v != N; ++v)
+      {
+         if (!active(v))
+            return v;
+      }
+
+      std::size_t r = 0;
+      if (_stealing == voice_stealing::oldest)
+      {
+         // Ages are relative to the clock, so this works across wrap around
+         for (std::size_t v = 1; v != N; ++v)
+         {
+            if (_clock - _age[v] > _clock - _age[r])
+               r = v;
+         }
+      }
+      else
+      {
+         for (std::size_t v = 1; v != N; ++v)
+         {
+            if (carrier_level(v) < carrier_level(r))
+               r = v;
+         }
+      }
+      return r;
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline void fm_synth<Algorithm, N>::note_on(std::uint8_t key, float velocity)
+   {
+      // Retrigger the key if it is still sounding, otherwise get a new voice
+      auto v = N;
+      for (std::size_t i = 0; i != N; ++i)
+      {
+         if (_key[i] == key && active(i))
+         {
+            v = i;
+            break;
+         }
+      }
+      if (v == N)
+      {
+         v = allocate();
+
+         // Start the phases and feedback of a new note on a free voice
+         // from zero. A stolen voice is still sounding, and its envelopes
+         // start from their current levels, so it keeps its phases and
+         // feedback, otherwise the waveform jumps (a click).
+         if (!active(v))
+         {
+            for (std::size_t k = 0; k != num_operators; ++k)
+            {
+               _phase[k][v] = 0;
+               _fb1[k][v] = _fb2[k][v] = 0.0f;
+            }
+         }
+      }
+
+      _key[v] = key;
+      _age[v] = ++_clock;
+      _freq[v] = as_double(midi::note_frequency(key));
+      for (std::size_t k = 0; k != num_operators; ++k)
+      {
+         _step[k][v] = phase(frequency(_freq[v] * _config[k].ratio), _sps).rep;
+         _env[k].trigger(v, velocity);
+      }
+      _groups = std::max(_groups, v / group_size + 1);
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline void fm_synth<Algorithm, N>::note_off(std::uint8_t key)
+   {
+      for (std::size_t v = 0; v != N; ++v)
+      {
+         if (_key[v] == key)
+         {
+            for (auto& env : _env)
+               env.release(v);
+         }
+      }
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline void fm_synth<Algorithm, N>::all_notes_off()
+   {
+      for (std::size_t v = 0; v != N; ++v)
+      {
+         for (auto& env : _env)
+            env.release(v);
+      }
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline void fm_synth<Algorithm, N>::all_sounds_off()
+   {
+      for (std::size_t v = 0; v != N; ++v)
+      {
+         for (auto& env : _env)
+            env.reset(v);
+      }
+      _groups = 0;
+   }
+
+   // Set the configuration of operator op. The new ratio applies to
+   // sounding notes as well.
+   template <typename Algorithm, std::size_t N>
+   inline void fm_synth<Algorithm, N>::config(
+      std::size_t op, operator_config const& config_)
+   {
+      _config[op] = config_;
+      _env[op].config(config_.envelope, _sps);
+      for (std::size_t v = 0; v != N; ++v)
+         _step[op][v] = phase(frequency(_freq[v] * config_.ratio), _sps).rep;
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline typename fm_synth<Algorithm, N>::operator_config const&
+   fm_synth<Algorithm, N>::config(std::size_t op) const
+   {
+      return _config[op];
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline void fm_synth<Algorithm, N>::stealing(voice_stealing policy)
+   {
+      _stealing = policy;
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline voice_stealing fm_synth<Algorithm, N>::stealing() const
+   {
+      return _stealing;
+   }
+
+   template <typename Algorithm, std::size_t N>
+   inline std::size_t fm_synth<Algorithm, N>::active_voices() const
+   {
+      std::size_t count = 0;
+      for (std::size_t v = 0; v != N; ++v)
+         count += active(v);
+      return count;
+   }
+}
+
+#endif
@@ -0,0 +1,458 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_NOISE_BANK_OCTOBER_19_2026)
+#define CYCFI_Q_NOISE_BANK_OCTOBER_19_2026
+
+#include <q/support/base.hpp>
+#include <q/detail/bank_base.hpp>
+#include <q/detail/count_bits.hpp>
+#include <q/synth/noise_synth.hpp>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace cycfi::q
+{
+   namespace detail
+   {
+      /////////////////////////////////////////////////////////////////////////
+      // philox4x32: The Philox-4x32-10 counter-based random number
+      // generator (Salmon et al., "Parallel Random Numbers: As Easy as
+      // 1, 2, 3", SC11). Returns four random words for a 128-bit counter
+      // and a 64-bit key. Each counter is independent, so the generator
+      // has no state, can be seeked, and loops over counters can be
+      // vectorized.
+      /////////////////////////////////////////////////////////////////////////
+      using philox_words = std::array<std::uint32_t, 4>;
+
+      inline philox_words philox4x32(philox_words c, std::uint32_t k0, std::uint32_t k1)
+      {
+         constexpr std::uint32_t m0 = 0xD2511F53;
+         constexpr std::uint32_t m1 = 0xCD9E8D57;
+         constexpr std::uint32_t w0 = 0x9E3779B9;
+         constexpr std::uint32_t w1 = 0xBB67AE85;
+         auto [c0, c1, c2, c3] = c;
+         for (int r = 0; r != 10; ++r)
+         {
+            auto p0 = std::uint64_t(m0) * c0;
+            auto p1 = std::uint64_t(m1) * c2;
+            c0 = std::uint32_t(p1 >> 32) ^ c1 ^ k0;
+            c1 = std::uint32_t(p1);
+            c2 = std::uint32_t(p0 >> 32) ^ c3 ^ k1;
+            c3 = std::uint32_t(p0);
+            k0 += w0;
+            k1 += w1;
+         }
+         return { c0, c1, c2, c3 };
+      }
+
+      // The random words for counter i of lane k. Each generator uses its
+      // own stream, so that its lanes are independent of the lanes of the
+      // other generators, given the same seed.
+      enum noise_stream : std::uint32_t { white_stream, voss_stream };
+
+      inline philox_words noise_words(
+         std::uint32_t i, std::size_t k, std::uint32_t seed, noise_stream stream)
+      {
+         return philox4x32({ i, std::uint32_t(k), stream, 0 }, seed, 0);
+      }
+
+      // Random word to a sample in [-1, 1)
+      inline float noise_sample(std::uint32_t u)
+      {
+         return std::int32_t(u) * (1.0f / 2147483648.0f);
+      }
+
+      // Number of trailing zero bits (32 if i is zero)
+      inline std::uint32_t trailing_zeros(std::uint32_t i)
+      {
+         return count_bits(std::uint32_t((i & (0 - i)) - 1));
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // white_noise_bank: N independent white noise streams (lanes), with
+   // uniformly distributed samples in [-1, 1).
+   //
+   // Unlike white_noise_synth, the samples are generated using a
+   // counter-based generator (detail::philox4x32), given the seed, the
+   // lane and the sample position, with four samples per counter. Each
+   // lane is an independent stream that can be reproduced from any
+   // position using seek(pos). Use different seeds for independent banks.
+   // There is no shared state, so banks can be used from different
+   // threads.
+   //
+   // The per-sample function call operator generates the next frame. The
+   // four samples of each counter are generated for all lanes at once, in
+   // a loop across the lanes that the compiler can vectorize. The block
+   // render, render(out, n), given N output channels, generates each
+   // channel in a loop across the samples, which can be vectorized even
+   // for a single lane (N = 1).
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   class white_noise_bank
+   {
+   public:
+
+      using out_channels = std::array<float*, N>;
+      static constexpr std::size_t num_lanes = N;
+
+                              white_noise_bank(std::uint32_t seed = 0);
+
+      frame<N> const&         operator()();
+      frame<N> const&         current() const      { return _y; }
+      void                    render(out_channels const& out, std::size_t n);
+
+      void                    seek(std::uint32_t pos) { _pos = pos; }
+      std::uint32_t           position() const     { return _pos; }
+      std::uint32_t           seed() const         { return _seed; }
+
+   private:
+
+      using lanes = std::array<std::uint32_t, N>;
+
+      frame<N>                _y;
+      std::array<lanes, 4>    _words;     // words of counter _counter
+      std::uint32_t           _counter = 0;
+      bool                    _valid = false;
+      std::uint32_t           _seed;
+      std::uint32_t           _pos = 0;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // pink_noise_bank: N independent pink noise streams, made from the
+   // white_noise_bank streams using the same filter as pink_noise_synth:
+   // a bank of seven one-pole filters (-3dB/octave), with the filter
+   // states kept in SoA layout.
+   //
+   // The per-sample function call operator filters all lanes in a loop
+   // that the compiler can vectorize. The block render generates the
+   // white noise blocks first, then filters each channel, with the seven
+   // independent filters running in parallel.
+   //
+   // seek(pos) seeks the white noise streams only. The filter states are
+   // kept, so the output continues smoothly.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   class pink_noise_bank
+   {
+   public:
+
+      using out_channels = std::array<float*, N>;
+      static constexpr std::size_t num_lanes = N;
+      static constexpr std::size_t num_filters = 7;
+
+                              pink_noise_bank(float sps, std::uint32_t seed = 0);
+
+      frame<N> const&         operator()();
+      frame<N> const&         current() const      { return _y; }
+      void                    render(out_channels const& out, std::size_t n);
+
+      void                    seek(std::uint32_t pos) { _white.seek(pos); }
+      std::uint32_t           position() const     { return _white.position(); }
+
+   private:
+
+      white_noise_bank<N>     _white;
+      std::array<float, num_filters> _k;
+      std::array<frame<N>, num_filters> _b;
+      frame<N>                _y;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // voss_mccartney_bank: N independent pink noise streams using the
+   // Voss-McCartney algorithm, for test signals. The output is the sum of
+   // Rows random rows plus a white noise sample. Row r is updated with a
+   // new random value every 2^(r+1) samples: at sample i, the row given
+   // by the number of trailing zero bits of i is updated (none at i = 0).
+   // The rows start at zero.
+   //
+   // The rows and their sum are kept as integers, so the running sum is
+   // exact and has no drift. The output is deterministic, given the seed,
+   // the lane and the sample position, and seek(pos) restores the exact
+   // rows for any position. The output is in [-1, 1).
+   //
+   // Each counter of the random number generator gives the white noise
+   // and row values of two samples. The per-sample function call operator
+   // updates all lanes in loops that the compiler can vectorize. Rows
+   // must be at most 31.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N, std::size_t Rows = 16>
+   class voss_mccartney_bank
+   {
+   public:
+
+      static_assert(Rows >= 1 && Rows <= 31, "Error: Rows must be 1 to 31");
+
+      using out_channels = std::array<float*, N>;
+      static constexpr std::size_t num_lanes = N;
+      static constexpr std::size_t num_rows = Rows;
+
+                              voss_mccartney_bank(std::uint32_t seed = 0);
+
+      frame<N> const&         operator()();
+      frame<N> const&         current() const      { return _y; }
+      void                    render(out_channels const& out, std::size_t n);
+
+      void                    seek(std::uint32_t pos);
+      std::uint32_t           position() const     { return _pos; }
+
+   private:
+
+      // Each value has 32 - shift bits, so that the sum of Rows + 1
+      // values fits in 32 bits
+      static constexpr int shift = 5;
+      static constexpr float scale =
+         1.0f / (float(Rows + 1) * float(1u << (31 - shift)));
+
+      using lanes = std::array<std::int32_t, N>;
+
+      void                    generate(std::uint32_t c);
+
+      std::array<lanes, Rows> _rows;
+      lanes                   _sum;
+      frame<N>                _y;
+      std::array<lanes, 4>    _words;     // values of counter _counter
+      std::uint32_t           _counter = 0;
+      bool                    _valid = false;
+      std::uint32_t           _seed;
+      std::uint32_t           _pos = 0;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   inline white_noise_bank<N>::white_noise_bank(std::uint32_t seed)
+    : _seed(seed)
+   {
+      _y.fill(0.0f);
+   }
+
+   template <std::size_t N>
+   inline frame<N> const& white_noise_bank<N>::operator()()
+   {
+      auto const pos = _pos++;
+      auto const c = pos >> 2;
+      if (!_valid || c != _counter)
+      {
+         auto const seed = _seed;
+         for (std::size_t k = 0; k != N; ++k)
+         {
+            auto u = detail::noise_words(c, k, seed, detail::white_stream);
+            _words[0][k] = u[0];
+            _words[1][k] = u[1];
+            _words[2][k] = u[2];
+            _words[3][k] = u[3];
+         }
+         _counter = c;
+         _valid = true;
+      }
+
+      auto const& w = _words[pos & 3];
+      for (std::size_t k = 0; k != N; ++k)
+         _y[k] = detail::noise_sample(w[k]);
+      return _y;
+   }
+
+   template <std::size_t N>
+   inline void white_noise_bank<N>::render(out_channels const& out, std::size_t n)
+   {
+      if (n == 0)
+         return;
+      auto const seed = _seed;
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         auto* y = out[k];
+         auto sample = [&](std::uint32_t p)
+         {
+            auto u = detail::noise_words(p >> 2, k, seed, detail::white_stream);
+            return detail::noise_sample(u[p & 3]);
+         };
+
+         // Up to the first whole counter, then four samples per counter
+         auto p = _pos;
+         std::size_t i = 0;
+         for (; i != n && (p & 3) != 0; ++i, ++p)
+            y[i] = sample(p);
+
+         auto const c = p >> 2;
+         auto const whole = (n - i) / 4;
+         auto* y4 = y + i;
+         for (std::size_t j = 0; j != whole; ++j)
+         {
+            auto u = detail::noise_words(c + j, k, seed, detail::white_stream);
+            y4[j * 4] = detail::noise_sample(u[0]);
+            y4[j * 4 + 1] = detail::noise_sample(u[1]);
+            y4[j * 4 + 2] = detail::noise_sample(u[2]);
+            y4[j * 4 + 3] = detail::noise_sample(u[3]);
+         }
+         i += whole * 4;
+         p += whole * 4;
+
+         for (; i != n; ++i, ++p)
+            y[i] = sample(p);
+         _y[k] = y[n-1];
+      }
+      _pos += n;
+   }
+
+   template <std::size_t N>
+   inline pink_noise_bank<N>::pink_noise_bank(float sps, std::uint32_t seed)
+    : _white(seed)
+   {
+      for (std::size_t i = 0; i != num_filters; ++i)
+      {
+         _k[i] = fastexp(-2.0f * pi * pink_noise_synth::f[i] / sps);
+         _b[i].fill(0.0f);
+      }
+      _y.fill(0.0f);
+   }
+
+   template <std::size_t N>
+   inline frame<N> const& pink_noise_bank<N>::operator()()
+   {
+      auto const& w = _white();
+      for (std::size_t i = 0; i != num_filters; ++i)
+      {
+         auto const k = _k[i];
+         auto& b = _b[i];
+         for (std::size_t v = 0; v != N; ++v)
+            b[v] = k * (w[v] + b[v]);
+      }
+      for (std::size_t v = 0; v != N; ++v)
+      {
+         _y[v] = 0.05f * (
+            _b[0][v] + _b[1][v] + _b[2][v] + _b[3][v] + _b[4][v] + _b[5][v]
+          + w[v] - _b[6][v]
+         );
+      }
+      return _y;
+   }
+
+   template <std::size_t N>
+   inline void pink_noise_bank<N>::render(out_channels const& out, std::size_t n)
+   {
+      if (n == 0)
+         return;
+      _white.render(out, n);
+
+      auto const [k0, k1, k2, k3, k4, k5, k6] = _k;
+      for (std::size_t v = 0; v != N; ++v)
+      {
+         auto b0 = _b[0][v], b1 = _b[1][v], b2 = _b[2][v], b3 = _b[3][v];
+         auto b4 = _b[4][v], b5 = _b[5][v], b6 = _b[6][v];
+         auto* y = out[v];
+         for (std::size_t i = 0; i != n; ++i)
+         {
+            auto w = y[i];
+            b0 = k0 * (w + b0);
+            b1 = k1 * (w + b1);
+            b2 = k2 * (w + b2);
+            b3 = k3 * (w + b3);
+            b4 = k4 * (w + b4);
+            b5 = k5 * (w + b5);
+            b6 = k6 * (w + b6);
+            y[i] = 0.05f * (b0 + b1 + b2 + b3 + b4 + b5 + w - b6);
+         }
+         _b[0][v] = b0; _b[1][v] = b1; _b[2][v] = b2; _b[3][v] = b3;
+         _b[4][v] = b4; _b[5][v] = b5; _b[6][v] = b6;
+         _y[v] = y[n-1];
+      }
+   }
+
+   template <std::size_t N, std::size_t Rows>
+   inline voss_mccartney_bank<N, Rows>::voss_mccartney_bank(std::uint32_t seed)
+    : _seed(seed)
+   {
+      seek(0);
+   }
+
+   // Generate the values of counter c: the white noise and row values of
+   // samples 2c and 2c + 1
+   template <std::size_t N, std::size_t Rows>
+   inline void voss_mccartney_bank<N, Rows>::generate(std::uint32_t c)
+   {
+      auto const seed = _seed;
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         auto u = detail::noise_words(c, k, seed, detail::voss_stream);
+         _words[0][k] = std::int32_t(u[0]) >> shift;
+         _words[1][k] = std::int32_t(u[1]) >> shift;
+         _words[2][k] = std::int32_t(u[2]) >> shift;
+         _words[3][k] = std::int32_t(u[3]) >> shift;
+      }
+      _counter = c;
+      _valid = true;
+   }
+
+   template <std::size_t N, std::size_t Rows>
+   inline void voss_mccartney_bank<N, Rows>::seek(std::uint32_t pos)
+   {
+      // Row r was last updated at the latest sample before pos of the
+      // form (2m + 1) * 2^r, if any.
+      _sum.fill(0);
+      for (std::size_t r = 0; r != Rows; ++r)
+      {
+         auto& row = _rows[r];
+         auto const one = std::uint32_t(1) << r;
+         if (pos == 0 || pos - 1 < one)
+         {
+            row.fill(0);
+            continue;
+         }
+         auto const m = (pos - 1 - one) >> (r + 1);
+         auto const i = ((m << 1) + 1) << r;
+         generate(i >> 1);
+         auto const& x = _words[(i & 1) * 2 + 1];
+         for (std::size_t k = 0; k != N; ++k)
+         {
+            row[k] = x[k];
+            _sum[k] += x[k];
+         }
+      }
+      _y.fill(0.0f);
+      _pos = pos;
+   }
+
+   template <std::size_t N, std::size_t Rows>
+   inline frame<N> const& voss_mccartney_bank<N, Rows>::operator()()
+   {
+      auto const pos = _pos++;
+      if (!_valid || (pos >> 1) != _counter)
+         generate(pos >> 1);
+
+      auto const& w = _words[(pos & 1) * 2];
+      auto const r = detail::trailing_zeros(pos);
+      if (r < Rows)
+      {
+         auto& row = _rows[r];
+         auto const& x = _words[(pos & 1) * 2 + 1];
+         for (std::size_t k = 0; k != N; ++k)
+         {
+            _sum[k] += x[k] - row[k];
+            row[k] = x[k];
+         }
+      }
+      for (std::size_t k = 0; k != N; ++k)
+         _y[k] = (_sum[k] + w[k]) * scale;
+      return _y;
+   }
+
+   template <std::size_t N, std::size_t Rows>
+   inline void voss_mccartney_bank<N, Rows>::render(
+      out_channels const& out, std::size_t n)
+   {
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         auto const& y = (*this)();
+         for (std::size_t k = 0; k != N; ++k)
+            out[k][i] = y[k];
+      }
+   }
+}
+
+#endif
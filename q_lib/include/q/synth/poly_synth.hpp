@@ -0,0 +1,409 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_POLY_SYNTH_OCTOBER_19_2026)
+#define CYCFI_Q_POLY_SYNTH_OCTOBER_19_2026
+
+#include <q/support/literals.hpp>
+#include <q/support/phase.hpp>
+#include <q/support/midi.hpp>
+#include <q/synth/envelope_gen_bank.hpp>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // voice_stealing: the policy for choosing the voice to steal when all
+   // voices are busy. oldest steals the voice with the oldest note-on.
+   // quietest steals the voice with the lowest envelope level.
+   ////////////////////////////////////////////////////////////////////////////
+   enum class voice_stealing
+   {
+      oldest
+    , quietest
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // poly_synth: an N voice polyphonic synthesizer, given a single-voice
+   // Synth functor (e.g. square_synth, saw_synth), called with a
+   // phase_iterator, and an ADSR envelope configuration (see
+   // envelope_gen).
+   //
+   // The voice state (phases, steps and envelopes) is kept in SoA
+   // (structure of arrays) layout, with the envelopes in an
+   // envelope_gen_bank. Voices are rendered in groups of group_size lanes,
+   // in branch-free inner loops that the compiler can vectorize across
+   // voices. Only groups up to the highest active voice are rendered, and
+   // new notes take the lowest free voice, so the active voices are kept
+   // packed at the low groups.
+   //
+   // A note-on on a voice with a level higher than the new velocity
+   // starts the decay to the new sustain level (see envelope_gen_bank).
+   //
+   // poly_synth is a midi::processor and may be driven by midi::dispatch.
+   // The time argument is the sample offset from the start of the next
+   // render(out, n) call. Events are queued and render splits the block at
+   // the event times (sample accurate). Offsets beyond the block are
+   // applied at the end of the block. Note-on, note-off, all notes off and
+   // all sounds off are handled. A note-on with zero velocity is a
+   // note-off.
+   //
+   // All buffers are fixed-size. When the event queue is full, the earliest
+   // event (queued or new) is applied immediately, ahead of its time, which
+   // keeps the events in order.
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename Synth, std::size_t N>
+   class poly_synth : public midi::processor
+   {
+   public:
+
+      static constexpr std::size_t group_size = envelope_gen_bank<N>::group_size;
+      static constexpr std::size_t num_voices = N;
+      static constexpr std::size_t queue_size = 256;
+
+      static_assert(N % group_size == 0, "Error: N must be a multiple of group_size");
+
+                           poly_synth(
+                              Synth synth
+                            , envelope_gen::config const& config
+                            , float sps
+                            , voice_stealing stealing_ = voice_stealing::oldest
+                           );
+
+      using midi::processor::operator();
+
+      void                 operator()(midi::note_on msg, std::size_t time);
+      void                 operator()(midi::note_off msg, std::size_t time);
+      void                 operator()(midi::control_change msg, std::size_t time);
+
+      void                 render(float* out, std::size_t n);
+
+      void                 note_on(std::uint8_t key, float velocity);
+      void                 note_off(std::uint8_t key);
+      void                 all_notes_off();
+      void                 all_sounds_off();
+
+      void                 stealing(voice_stealing policy);
+      voice_stealing       stealing() const;
+      std::size_t          active_voices() const;
+      Synth&               synth();
+
+   private:
+
+      struct event
+      {
+         std::size_t       time;
+         std::uint8_t      status;
+         std::uint8_t      data1;
+         std::uint8_t      data2;
+      };
+
+      void                 push(event const& ev);
+      void                 apply(event const& ev);
+      void                 render_block(float* out, std::size_t n);
+      std::size_t          allocate();
+      void                 update_groups();
+
+      Synth                _synth;
+      float                _sps;
+      voice_stealing       _stealing;
+
+      // Voice state (SoA)
+      std::array<phase, N> _phase;
+      std::array<phase, N> _step;
+      envelope_gen_bank<N> _env;
+      std::array<std::uint8_t, N> _key;
+      std::array<std::uint32_t, N> _age;
+
+      std::uint32_t        _clock = 0;
+      std::size_t          _groups = 0;   // groups up to the highest active voice
+
+      std::array<event, queue_size> _queue;
+      std::size_t          _queue_count = 0;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename Synth, std::size_t N>
+   inline poly_synth<Synth, N>::poly_synth(
+      Synth synth
+    , envelope_gen::config const& config
+    , float sps
+    , voice_stealing stealing_
+   )
+    : _synth(synth)
+    , _sps(sps)
+    , _stealing(stealing_)
+    , _env(config, sps)
+   {
+      _phase.fill(phase{});
+      _step.fill(phase{});
+      _key.fill(0);
+      _age.fill(0);
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::update_groups()
+   {
+      _groups = 0;
+      for (std::size_t v = N; v != 0; --v)
+      {
+         if (_env.active(v-1))
+         {
+            _groups = (v - 1) / group_size + 1;
+            break;
+         }
+      }
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::render_block(float* out, std::size_t n)
+   {
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         float sum[group_size] = {};
+         for (std::size_t g = 0; g < _groups; ++g)
+         {
+            auto const base = g * group_size;
+
+            // Envelopes
+            if (_env.update(g))
+               update_groups();
+
+            // Oscillators
+            float osc[group_size];
+            for (std::size_t l = 0; l != group_size; ++l)
+            {
+               auto v = base + l;
+               phase_iterator it;
+               it._phase = _phase[v];
+               it._step = _step[v];
+               osc[l] = _synth(it);
+               _phase[v] += _step[v];
+            }
+            auto const& y = _env.levels();
+            for (std::size_t l = 0; l != group_size; ++l)
+               sum[l] += osc[l] * y[base + l];
+         }
+
+         float y = 0.0f;
+         for (auto s : sum)
+            y += s;
+         out[i] = y;
+      }
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::render(float* out, std::size_t n)
+   {
+      std::size_t i = 0;
+      std::size_t e = 0;
+      for (; e != _queue_count; ++e)
+      {
+         auto const& ev = _queue[e];
+         if (ev.time >= n)
+            break;
+         if (ev.time > i)
+         {
+            render_block(out + i, ev.time - i);
+            i = ev.time;
+         }
+         apply(ev);
+      }
+      render_block(out + i, n - i);
+
+      // Apply the events beyond the block
+      for (; e != _queue_count; ++e)
+         apply(_queue[e]);
+      _queue_count = 0;
+   }
+
+   // Queue the event, keeping the queue sorted by time (stable)
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::push(event const& ev)
+   {
+      if (_queue_count == queue_size)
+      {
+         // Make room by applying the earliest event now. Applying the new
+         // event ahead of earlier queued events would reorder them (e.g. a
+         // note-off before its note-on, leaving a stuck voice).
+         if (ev.time < _queue[0].time)
+         {
+            apply(ev);
+            return;
+         }
+         apply(_queue[0]);
+         std::copy(_queue.begin() + 1, _queue.end(), _queue.begin());
+         --_queue_count;
+      }
+      auto i = _queue_count++;
+      for (; i != 0 && _queue[i-1].time > ev.time; --i)
+         _queue[i] = _queue[i-1];
+      _queue[i] = ev;
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::apply(event const& ev)
+   {
+      switch (ev.status)
+      {
+         case midi::status::note_on:
+            if (ev.data2 == 0)
+               note_off(ev.data1);
+            else
+               note_on(ev.data1, float(ev.data2) / 128);
+            break;
+
+         case midi::status::note_off:
+            note_off(ev.data1);
+            break;
+
+         case midi::status::control_change:
+            if (ev.data1 == midi::cc::all_notes_off)
+               all_notes_off();
+            else if (ev.data1 == midi::cc::all_sounds_off)
+               all_sounds_off();
+            break;
+      }
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::operator()(midi::note_on msg, std::size_t time)
+   {
+      push({ time, midi::status::note_on, msg.key(), msg.velocity() });
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::operator()(midi::note_off msg, std::size_t time)
+   {
+      push({ time, midi::status::note_off, msg.key(), msg.velocity() });
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::operator()(midi::control_change msg, std::size_t time)
+   {
+      switch (msg.controller())
+      {
+         case midi::cc::all_notes_off:
+         case midi::cc::all_sounds_off:
+            push({ time, midi::status::control_change, msg.controller(), msg.value() });
+            break;
+
+         default:
+            break;
+      }
+   }
+
+   // Find a voice for a new note: the lowest free voice, or a voice to
+   // steal, according to the voice_stealing policy.
+   template <typename Synth, std::size_t N>
+   inline std::size_t poly_synth<Synth, N>::allocate()
+   {
+      for (std::size_t v = 0; v != N; ++v)
+      {
+         if (!_env.active(v))
+            return v;
+      }
+
+      std::size_t r = 0;
+      if (_stealing == voice_stealing::oldest)
+      {
+         // Ages are relative to the clock, so this works across wrap around
+         for (std::size_t v = 1; v != N; ++v)
+         {
+            if (_clock - _age[v] > _clock - _age[r])
+               r = v;
+         }
+      }
+      else
+      {
+         auto const& y = _env.levels();
+         r = std::min_element(y.begin(), y.end()) - y.begin();
+      }
+      return r;
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::note_on(std::uint8_t key, float velocity)
+   {
+      // Retrigger the key if it is still sounding, otherwise get a new voice
+      auto v = N;
+      for (std::size_t i = 0; i != N; ++i)
+      {
+         if (_key[i] == key && _env.active(i))
+         {
+            v = i;
+            break;
+         }
+      }
+      // A stolen voice keeps its phase, and its envelope starts from its
+      // current level, so it continues without a jump (a click)
+      if (v == N)
+         v = allocate();
+
+      _key[v] = key;
+      _age[v] = ++_clock;
+      _step[v] = phase(midi::note_frequency(key), _sps);
+      _env.trigger(v, velocity);
+      _groups = std::max(_groups, v / group_size + 1);
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::note_off(std::uint8_t key)
+   {
+      for (std::size_t v = 0; v != N; ++v)
+      {
+         if (_key[v] == key)
+            _env.release(v);
+      }
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::all_notes_off()
+   {
+      for (std::size_t v = 0; v != N; ++v)
+         _env.release(v);
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::all_sounds_off()
+   {
+      for (std::size_t v = 0; v != N; ++v)
+         _env.reset(v);
+      _groups = 0;
+   }
+
+   template <typename Synth, std::size_t N>
+   inline void poly_synth<Synth, N>::stealing(voice_stealing policy)
+   {
+      _stealing = policy;
+   }
+
+   template <typename Synth, std::size_t N>
+   inline voice_stealing poly_synth<Synth, N>::stealing() const
+   {
+      return _stealing;
+   }
+
+   template <typename Synth, std::size_t N>
+   inline std::size_t poly_synth<Synth, N>::active_voices() const
+   {
+      std::size_t count = 0;
+      for (std::size_t v = 0; v != N; ++v)
+         count += _env.active(v);
+      return count;
+   }
+
+   template <typename Synth, std::size_t N>
+   inline Synth& poly_synth<Synth, N>::synth()
+   {
+      return _synth;
+   }
+}
+
+#endif
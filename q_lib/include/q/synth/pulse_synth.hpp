@@ -67,6 +67,27 @@ namespace cycfi::q
       {
          return (*this)(i._phase, i._step);
       }
+
+      // Render n samples to out and advance i. The naive waveform is
+      // computed in a branch-free loop and the discontinuities are
+      // corrected afterwards (see add_poly_blep).
+      void render(phase_iterator& i, float* out, std::size_t n) const
+      {
+         constexpr auto end = phase::end();
+         auto const shift = _shift.rep;
+         auto p = i._phase.rep;
+         auto const dt = i._step.rep;
+         for (std::size_t k = 0; k != n; ++k, p += dt)
+            out[k] = p < shift ? 1.0f : -1.0f;
+
+         // Correct rising discontinuity
+         add_poly_blep(out, n, i._phase, i._step, 1.0f);
+
+         // Correct falling discontinuity
+         add_poly_blep(out, n, i._phase + (end - _shift), i._step, -1.0f);
+
+         i._phase = phase(p);
+      }
    };
 
    constexpr auto pulse = pulse_synth{};
@@ -0,0 +1,233 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_SIN_COS_GEN_BANK_OCTOBER_19_2026)
+#define CYCFI_Q_SIN_COS_GEN_BANK_OCTOBER_19_2026
+
+#include <q/support/literals.hpp>
+#include <q/detail/bank_base.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // sin_cos_gen_bank: N quadrature oscillators (lanes), each generating a
+   // sine and a cosine wave, e.g. for heterodyning, additive synthesis and
+   // Goertzel-style analysis of many frequencies at once.
+   //
+   // Each lane is a rotation of the (cos, sin) vector by the lane's phase
+   // increment, w = 2pi f/sps, every sample:
+   //
+   //    cos' = cos * cos(w) - sin * sin(w)
+   //    sin' = sin * cos(w) + cos * sin(w)
+   //
+   // Unlike sin_cos_gen, the rotation is exact for all frequencies up to
+   // Nyquist, with no skew between the sine and the cosine. The rounding
+   // errors would make the amplitude drift, so the vectors are
+   // renormalized every renormalize_interval samples, using the
+   // first-order approximation of 1/sqrt(x) near 1, (3 - x)/2, which needs
+   // no division or square root.
+   //
+   // The state is kept in SoA (structure of arrays) layout, and all lanes
+   // are updated in branch-free loops that the compiler can vectorize.
+   // Choose N to be a multiple of the SIMD width. The per-sample function
+   // call operator returns the sine and cosine frames. Block rendering is
+   // available via render(sin_out, cos_out, n), given N sine and N cosine
+   // output channels.
+   //
+   // Changing a lane's frequency keeps its phase, so frequency changes are
+   // continuous.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   class sin_cos_gen_bank
+   {
+   public:
+
+      using out_channels = std::array<float*, N>;
+      using result_type = std::pair<frame<N> const&, frame<N> const&>;
+
+      static constexpr std::size_t num_lanes = N;
+      static constexpr std::size_t renormalize_interval = 32;
+
+                              sin_cos_gen_bank();
+                              sin_cos_gen_bank(frequency f, float sps);
+
+      result_type             operator()();
+      void                    render(
+                                 out_channels const& sin_out
+                               , out_channels const& cos_out
+                               , std::size_t n
+                              );
+
+      frame<N> const&         sin() const    { return _sin; }
+      frame<N> const&         cos() const    { return _cos; }
+
+      void                    config(frequency f, float sps);
+      void                    config(std::size_t k, frequency f, float sps);
+      void                    phase(std::size_t k, float radians);
+      void                    reset();
+
+   private:
+
+      void                    update();
+      void                    renormalize();
+
+      frame<N>                _sin, _cos;       // Oscillator state
+      frame<N>                _sin_w, _cos_w;   // Rotation per sample
+      std::size_t             _count = 0;       // Samples since renormalize
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   inline sin_cos_gen_bank<N>::sin_cos_gen_bank()
+   {
+      _sin_w.fill(0.0f);
+      _cos_w.fill(1.0f);
+      reset();
+   }
+
+   template <std::size_t N>
+   inline sin_cos_gen_bank<N>::sin_cos_gen_bank(frequency f, float sps)
+   {
+      config(f, sps);
+      reset();
+   }
+
+   template <std::size_t N>
+   inline void sin_cos_gen_bank<N>::config(frequency f, float sps)
+   {
+      for (std::size_t k = 0; k != N; ++k)
+         config(k, f, sps);
+   }
+
+   template <std::size_t N>
+   inline void sin_cos_gen_bank<N>::config(std::size_t k, frequency f, float sps)
+   {
+      double w = 2_pi * as_double(f) / sps;
+      _sin_w[k] = std::sin(w);
+      _cos_w[k] = std::cos(w);
+   }
+
+   // Set the phase of lane k (the sine is sin(radians), and the cosine,
+   // cos(radians))
+   template <std::size_t N>
+   inline void sin_cos_gen_bank<N>::phase(std::size_t k, float radians)
+   {
+      _sin[k] = std::sin(radians);
+      _cos[k] = std::cos(radians);
+   }
+
+   // Reset all lanes to phase 0 (sine = 0, cosine = 1)
+   template <std::size_t N>
+   inline void sin_cos_gen_bank<N>::reset()
+   {
+      _sin.fill(0.0f);
+      _cos.fill(1.0f);
+      _count = 0;
+   }
+
+   template <std::size_t N>
+   inline void sin_cos_gen_bank<N>::update()
+   {
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         auto s = _sin[k];
+         auto c = _cos[k];
+         _cos[k] = c * _cos_w[k] - s * _sin_w[k];
+         _sin[k] = s * _cos_w[k] + c * _sin_w[k];
+      }
+   }
+
+   template <std::size_t N>
+   inline void sin_cos_gen_bank<N>::renormalize()
+   {
+      for (std::size_t k = 0; k != N; ++k)
+      {
+         auto g = 1.5f - 0.5f * (_sin[k] * _sin[k] + _cos[k] * _cos[k]);
+         _sin[k] *= g;
+         _cos[k] *= g;
+      }
+      _count = 0;
+   }
+
+   template <std::size_t N>
+   inline typename sin_cos_gen_bank<N>::result_type
+   sin_cos_gen_bank<N>::operator()()
+   {
+      if (_count == renormalize_interval)
+         renormalize();
+      update();
+      ++_count;
+      return { _sin, _cos };
+   }
+
+   template <std::size_t N>
+   inline void sin_cos_gen_bank<N>::render(
+      out_channels const& sin_out
+    , out_channels const& cos_out
+    , std::size_t n
+   )
+   {
+      // Render up to the next renormalization into local (lane x time)
+      // tiles, up to tile_lanes lanes at a time, vectorized across the
+      // lanes, then copy each channel's samples contiguously. Storing to
+      // all the channels every sample is several times slower.
+      constexpr auto tile_lanes = std::min<std::size_t>(N, 64);
+      constexpr auto tile_size = renormalize_interval;
+      alignas(64) float sin_tile[tile_lanes][tile_size];
+      alignas(64) float cos_tile[tile_lanes][tile_size];
+
+      auto s = _sin;
+      auto c = _cos;
+      for (std::size_t i = 0; i != n;)
+      {
+         if (_count == renormalize_interval)
+         {
+            for (std::size_t k = 0; k != N; ++k)
+            {
+               auto g = 1.5f - 0.5f * (s[k] * s[k] + c[k] * c[k]);
+               s[k] *= g;
+               c[k] *= g;
+            }
+            _count = 0;
+         }
+
+         auto size = std::min(n - i, renormalize_interval - _count);
+         for (std::size_t first = 0; first < N; first += tile_lanes)
+         {
+            auto lanes = std::min(tile_lanes, N - first);
+            for (std::size_t j = 0; j != size; ++j)
+            {
+               for (std::size_t l = 0; l != lanes; ++l)
+               {
+                  auto k = first + l;
+                  auto s_ = s[k];
+                  auto c_ = c[k];
+                  c[k] = c_ * _cos_w[k] - s_ * _sin_w[k];
+                  s[k] = s_ * _cos_w[k] + c_ * _sin_w[k];
+                  sin_tile[l][j] = s[k];
+                  cos_tile[l][j] = c[k];
+               }
+            }
+            for (std::size_t l = 0; l != lanes; ++l)
+            {
+               std::copy_n(sin_tile[l], size, sin_out[first + l] + i);
+               std::copy_n(cos_tile[l], size, cos_out[first + l] + i);
+            }
+         }
+         _count += size;
+         i += size;
+      }
+      _sin = s;
+      _cos = c;
+   }
+}
+
+#endif
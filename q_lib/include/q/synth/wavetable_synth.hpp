@@ -0,0 +1,228 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_WAVETABLE_SYNTH_HPP_OCTOBER_19_2026)
+#define CYCFI_Q_WAVETABLE_SYNTH_HPP_OCTOBER_19_2026
+
+#include <q/support/phase.hpp>
+#include <q/support/base.hpp>
+#include <q/fft/fft.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace cycfi::q
+{
+   namespace detail
+   {
+      constexpr std::size_t ilog2(std::size_t n)
+      {
+         return (n <= 1)? 0 : 1 + ilog2(n / 2);
+      }
+   }
+
+   ////////////////////////////////////////////////////////////////////////////
+   // wavetable_synth: Synthesizes an arbitrary single-cycle waveform,
+   // band-limited using mipmapped wavetables.
+   //
+   // The waveform is given either as N samples of one cycle, or as a
+   // function of phase (e.g. basic_saw) that is sampled N times. At
+   // construction, the cycle is transformed using fft<N> and one table is
+   // generated per octave (mip level), each keeping only the harmonics
+   // that are below Nyquist for the frequencies it is used for. Level k
+   // has harmonics up to (N/2) >> k, down to the last level, which has the
+   // fundamental only.
+   //
+   // The mip level is computed from the phase increment (dt). The
+   // fractional part of the level is used to crossfade between two
+   // adjacent levels, so there are no audible steps when the frequency is
+   // swept. Both levels have all their harmonics below Nyquist, hence the
+   // output is alias-free. Each sample costs two linearly interpolated
+   // table lookups, the same lookup sin_lu does (see table_lookup).
+   //
+   // N is the table size and must be a power of 2. The tables take
+   // (log2(N/2) + 1) * (N + 1) floats (e.g. 88 KB for N = 2048).
+   //
+   // Block rendering is available via render(phase_iterator&, out, n). The
+   // mip levels and crossfade are computed once per block.
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N = 2048>
+   class wavetable_synth
+   {
+   public:
+
+      static_assert(N >= 8 && (N & (N-1)) == 0, "Error: N must be a power of 2");
+
+      static constexpr std::size_t size = N;
+      static constexpr std::size_t size_bits = detail::ilog2(N);
+      static constexpr std::size_t levels = size_bits;   // log2(N/2) + 1
+
+      template <
+         typename F
+       , typename = std::enable_if_t<std::is_invocable_r_v<float, F, phase>>>
+      explicit       wavetable_synth(F const& f);
+      explicit       wavetable_synth(float const* cycle);
+
+      float          operator()(phase p, phase dt) const;
+      float          operator()(phase_iterator i) const;
+      void           render(phase_iterator& i, float* out, std::size_t n) const;
+
+      float const*   table(std::size_t level) const;
+      static float   mip_level(phase dt);
+
+   private:
+
+      void           generate(std::vector<double>& cycle);
+      float          lookup(phase p, std::size_t level, float t) const;
+
+      static constexpr std::size_t stride = N + 1; // with a guard point
+      static constexpr auto low_bits = phase::bits - size_bits;
+
+      std::vector<float> _tables;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <std::size_t N>
+   template <typename F, typename>
+   inline wavetable_synth<N>::wavetable_synth(F const& f)
+    : _tables(levels * stride)
+   {
+      std::vector<double> cycle(N);
+      for (std::size_t i = 0; i != N; ++i)
+         cycle[i] = f(phase(std::uint32_t(i) << low_bits));
+      generate(cycle);
+   }
+
+   template <std::size_t N>
+   inline wavetable_synth<N>::wavetable_synth(float const* cycle_)
+    : _tables(levels * stride)
+   {
+      std::vector<double> cycle(cycle_, cycle_ + N);
+      generate(cycle);
+   }
+
+   template <std::size_t N>
+   inline void wavetable_synth<N>::generate(std::vector<double>& cycle)
+   {
+      // Spectrum of the cycle. data is N complex values (real, imaginary)
+      std::vector<double> spectrum(N * 2, 0.0);
+      for (std::size_t i = 0; i != N; ++i)
+         spectrum[i * 2] = cycle[i];
+      fft<N>(spectrum.data());
+
+      std::vector<double> data(N * 2);
+      for (std::size_t k = 0; k != levels; ++k)
+      {
+         // Keep the DC and the harmonics up to max_h, but never the
+         // table's own Nyquist bin (N/2)
+         auto const max_h = std::min((N / 2) >> k, N / 2 - 1);
+         std::fill(data.begin(), data.end(), 0.0);
+         data[0] = spectrum[0];
+         for (std::size_t h = 1; h <= max_h; ++h)
+         {
+            // Positive and negative frequency bins, conjugated, so that
+            // applying fft<N> again computes the inverse transform.
+            data[h * 2] = spectrum[h * 2];
+            data[h * 2 + 1] = -spectrum[h * 2 + 1];
+            data[(N - h) * 2] = spectrum[(N - h) * 2];
+            data[(N - h) * 2 + 1] = -spectrum[(N - h) * 2 + 1];
+         }
+         data[1] = -spectrum[1];
+         fft<N>(data.data());
+
+         auto* table = _tables.data() + k * stride;
+         for (std::size_t i = 0; i != N; ++i)
+            table[i] = data[i * 2] / N;
+         table[N] = table[0];
+      }
+   }
+
+   // Returns the (fractional) mip level for the phase increment dt. Level
+   // k is alias-free for as long as dt is less than 1/(N >> k) of a cycle.
+   // The level is log2(2 * N * dt) where dt is in cycles, approximated
+   // piecewise linearly using the float exponent and mantissa bits (exact
+   // at powers of 2, monotonic in between). It is clamped to the valid
+   // levels.
+   template <std::size_t N>
+   inline float wavetable_synth<N>::mip_level(phase dt)
+   {
+      constexpr float scale = float(N * 2) / pow2<float>(phase::bits);
+      float x = dt.rep * scale;
+      std::uint32_t bits;
+      std::memcpy(&bits, &x, sizeof(bits));
+      auto level = (bits * (1.0f / (1 << 23))) - 127.0f;
+      return std::clamp(level, 0.0f, float(levels - 1));
+   }
+
+   template <std::size_t N>
+   inline float wavetable_synth<N>::lookup(
+      phase p, std::size_t level, float t) const
+   {
+      constexpr auto mask = (1u << low_bits) - 1;
+      constexpr auto factor = 1.0f / (1u << low_bits);
+
+      auto const* t1 = _tables.data() + level * stride;
+      auto const* t2 = t1 + ((level + 1 < levels)? stride : 0);
+      auto const index = p.rep >> low_bits;
+      auto const frac = (p.rep & mask) * factor;
+      auto y1 = linear_interpolate(t1[index], t1[index + 1], frac);
+      auto y2 = linear_interpolate(t2[index], t2[index + 1], frac);
+      return linear_interpolate(y1, y2, t);
+   }
+
+   template <std::size_t N>
+   inline float wavetable_synth<N>::operator()(phase p, phase dt) const
+   {
+      auto const level = mip_level(dt);
+      auto const k = std::size_t(level);
+      return lookup(p, k, level - k);
+   }
+
+   template <std::size_t N>
+   inline float wavetable_synth<N>::operator()(phase_iterator i) const
+   {
+      return (*this)(i._phase, i._step);
+   }
+
+   template <std::size_t N>
+   inline void wavetable_synth<N>::render(
+      phase_iterator& i, float* out, std::size_t n) const
+   {
+      constexpr auto mask = (1u << low_bits) - 1;
+      constexpr auto factor = 1.0f / (1u << low_bits);
+
+      auto const level = mip_level(i._step);
+      auto const k = std::size_t(level);
+      auto const t = level - k;
+      auto const* t1 = _tables.data() + k * stride;
+      auto const* t2 = t1 + ((k + 1 < levels)? stride : 0);
+
+      auto p = i._phase.rep;
+      auto const dt = i._step.rep;
+      for (std::size_t j = 0; j != n; ++j, p += dt)
+      {
+         auto const index = p >> low_bits;
+         auto const frac = (p & mask) * factor;
+         auto y1 = linear_interpolate(t1[index], t1[index + 1], frac);
+         auto y2 = linear_interpolate(t2[index], t2[index + 1], frac);
+         out[j] = linear_interpolate(y1, y2, t);
+      }
+      i._phase = phase(p);
+   }
+
+   // Get the table for mip level k (N + 1 samples, the last being equal to
+   // the first)
+   template <std::size_t N>
+   inline float const* wavetable_synth<N>::table(std::size_t level) const
+   {
+      return _tables.data() + level * stride;
+   }
+}
+
+#endif
@@ -7,6 +7,8 @@
 #define CYCFI_Q_ANTIALIASING_HPP_MAY_19_2018
 
 #include <q/support/phase.hpp>
+#include <cstddef>
+#include <cstdint>
 
 namespace cycfi::q
 {
@@ -30,6 +32,58 @@ namespace cycfi::q
       }
    }
 
+   ////////////////////////////////////////////////////////////////////////////
+   // add_poly_blep: Adds gain * poly_blep(p + i * dt, dt) to out[i] for the
+   // n samples of a block, where p is the phase of the first sample.
+   //
+   // poly_blep is non-zero only at the two samples around a phase wrap.
+   // These are at predictable positions, given p and dt, so instead of
+   // testing every sample, we step directly from one wrap to the next.
+   // This lets the caller compute the naive waveform in a branch-free
+   // (vectorizable) loop and then correct only the few samples near the
+   // discontinuities.
+   ////////////////////////////////////////////////////////////////////////////
+   inline void add_poly_blep(
+      float* out, std::size_t n, phase p, phase dt, float gain)
+   {
+      if (n == 0 || dt.rep == 0)
+         return;
+
+      constexpr auto cycle = std::uint64_t{1} << phase::bits;
+      auto const step = std::uint64_t{dt.rep};
+      auto at = [&](std::uint64_t i)
+      {
+         return phase(p.rep + std::uint32_t(i) * dt.rep);
+      };
+
+      // The first sample may be just after a wrap
+      auto last = cycle; // last index corrected
+      if (p < dt)
+      {
+         out[0] += gain * poly_blep(p, dt);
+         last = 0;
+      }
+
+      // j is the index of the first sample after the next wrap
+      auto j = (cycle - p.rep + step - 1) / step;
+      while (j - 1 < n)
+      {
+         if (j - 1 != last)
+            out[j-1] += gain * poly_blep(at(j-1), dt);
+         if (j < n)
+         {
+            auto q = at(j);
+            out[j] += gain * poly_blep(q, dt);
+            last = j;
+            j += (cycle - q.rep + step - 1) / step;
+         }
+         else
+         {
+            break;
+         }
+      }
+   }
+
    constexpr double poly_blamp(phase p, phase dt, float scale)
    {
       constexpr auto end = phase::end();
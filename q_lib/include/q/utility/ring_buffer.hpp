@@ -8,6 +8,8 @@
 
 #include <vector>
 #include <array>
+#include <utility>
+#include <infra/iterator_range.hpp>
 #include <q/support/base.hpp>
 #include <q/detail/init_store.hpp>
 #include <q/utility/interpolation.hpp>
@@ -16,6 +18,11 @@ namespace cycfi::q
 {
    ////////////////////////////////////////////////////////////////////////////
    // ring_buffer
+   //
+   // Elements are stored in chronological order (oldest to latest, wrapping
+   // around at the end of the storage). This allows blocks of elements to be
+   // pushed and read using at most two contiguous copies, and allows direct
+   // (zero-copy) access to the underlying storage via `segments`.
    ////////////////////////////////////////////////////////////////////////////
    template <typename T, typename Storage = std::vector<T>>
    class ring_buffer
@@ -26,6 +33,8 @@ namespace cycfi::q
       using storage_type = Storage;
       using index_type = std::size_t;
       using interpolation_type = sample_interpolation::none;
+      using range_type = iterator_range<T*>;
+      using const_range_type = iterator_range<T const*>;
 
                         explicit ring_buffer();
                         explicit ring_buffer(std::size_t size);
@@ -37,6 +46,12 @@ namespace cycfi::q
 
       std::size_t       size() const;
       void              push(T val);
+      void              push(T const* data, std::size_t n);
+                        template <typename U>
+      void              push(iterator_range<U*> block);
+      void              read(std::size_t index, T* out, std::size_t n) const;
+                        template <typename U>
+      void              read(std::size_t index, iterator_range<U*> out) const;
       T const&          front() const;
       T&                front();
       T const&          back() const;
@@ -44,8 +59,14 @@ namespace cycfi::q
       T const&          operator[](std::size_t index) const;
       T&                operator[](std::size_t index);
       void              clear();
+      void              fill(T val);
       void              pop_front();
 
+      std::pair<range_type, range_type>
+                        segments(std::size_t index, std::size_t n);
+      std::pair<const_range_type, const_range_type>
+                        segments(std::size_t index, std::size_t n) const;
+
       Storage&          store();
       const Storage&    store() const;
 
@@ -88,8 +109,58 @@ namespace cycfi::q
    template <typename T, typename Storage>
    inline void ring_buffer<T, Storage>::push(T val)
    {
-      --_pos &= _mask;
       _data[_pos] = val;
+      ++_pos &= _mask;
+   }
+
+   // Push n elements, in chronological order (data[n-1] becomes the latest
+   // element). This is equivalent to pushing the elements one at a time, but
+   // done using at most two contiguous copies.
+   template <typename T, typename Storage>
+   inline void ring_buffer<T, Storage>::push(T const* data, std::size_t n)
+   {
+      // Only the latest size() elements will survive anyway
+      if (n > size())
+      {
+         data += n - size();
+         n = size();
+      }
+
+      auto const first = std::min(n, size() - _pos);
+      auto dest = _data.data();
+      std::copy(data, data + first, dest + _pos);
+      std::copy(data + first, data + n, dest);
+      _pos = (_pos + n) & _mask;
+   }
+
+   // Push a block of elements. See push(data, n) above.
+   template <typename T, typename Storage>
+   template <typename U>
+   inline void ring_buffer<T, Storage>::push(iterator_range<U*> block)
+   {
+      push(block.begin(), block.end() - block.begin());
+   }
+
+   // Read n elements, starting from b[index+n-1] up to b[index], in
+   // chronological order, into out. This is the inverse of push(data, n):
+   // after push(data, n), read(0, out, n) copies data to out. Requires
+   // index + n <= size().
+   template <typename T, typename Storage>
+   inline void ring_buffer<T, Storage>::read(
+      std::size_t index, T* out, std::size_t n) const
+   {
+      auto [a, b] = segments(index, n);
+      out = std::copy(a.begin(), a.end(), out);
+      std::copy(b.begin(), b.end(), out);
+   }
+
+   // Read a block of elements. See read(index, out, n) above.
+   template <typename T, typename Storage>
+   template <typename U>
+   inline void ring_buffer<T, Storage>::read(
+      std::size_t index, iterator_range<U*> out) const
+   {
+      read(index, out.begin(), out.end() - out.begin());
    }
 
    // Get the latest element.
@@ -125,7 +196,7 @@ namespace cycfi::q
    template <typename T, typename Storage>
    inline T const& ring_buffer<T, Storage>::operator[](std::size_t index) const
    {
-      return _data[(_pos + index) & _mask];
+      return _data[(_pos - index - 1) & _mask];
    }
 
    // Get the nth latest element (b[0] is latest element, b[1] is the second
@@ -133,7 +204,7 @@ namespace cycfi::q
    template <typename T, typename Storage>
    inline T& ring_buffer<T, Storage>::operator[](std::size_t index)
    {
-      return _data[(_pos + index) & _mask];
+      return _data[(_pos - index - 1) & _mask];
    }
 
    // Clear the ring_buffer
@@ -144,11 +215,59 @@ namespace cycfi::q
          e = T();
    }
 
+   // Set all elements to val
+   template <typename T, typename Storage>
+   inline void ring_buffer<T, Storage>::fill(T val)
+   {
+      for (auto& e : _data)
+         e = val;
+   }
+
    // Remove the front element
    template <typename T, typename Storage>
    inline void ring_buffer<T, Storage>::pop_front()
    {
-      ++_pos;
+      --_pos &= _mask;
+   }
+
+   // Get up to two contiguous ranges, in chronological order, covering the
+   // elements b[index+n-1] up to b[index]. The second range is empty if
+   // the elements do not wrap around the end of the storage. Requires
+   // index + n <= size().
+   template <typename T, typename Storage>
+   inline std::pair<
+      typename ring_buffer<T, Storage>::range_type
+    , typename ring_buffer<T, Storage>::range_type
+   >
+   ring_buffer<T, Storage>::segments(std::size_t index, std::size_t n)
+   {
+      auto const start = (_pos - index - n) & _mask;
+      auto const first = std::min(n, size() - start);
+      T* p = _data.data();
+      return {
+         range_type{p + start, p + start + first}
+       , range_type{p, p + (n - first)}
+      };
+   }
+
+   // Get up to two contiguous ranges, in chronological order, covering the
+   // elements b[index+n-1] up to b[index]. The second range is empty if
+   // the elements do not wrap around the end of the storage. Requires
+   // index + n <= size().
+   template <typename T, typename Storage>
+   inline std::pair<
+      typename ring_buffer<T, Storage>::const_range_type
+    , typename ring_buffer<T, Storage>::const_range_type
+   >
+   ring_buffer<T, Storage>::segments(std::size_t index, std::size_t n) const
+   {
+      auto const start = (_pos - index - n) & _mask;
+      auto const first = std::min(n, size() - start);
+      T const* p = _data.data();
+      return {
+         const_range_type{p + start, p + start + first}
+       , const_range_type{p, p + (n - first)}
+      };
    }
 
    // Raw access to the data storage
@@ -0,0 +1,268 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#if !defined(CYCFI_Q_SPSC_RING_BUFFER_OCTOBER_19_2026)
+#define CYCFI_Q_SPSC_RING_BUFFER_OCTOBER_19_2026
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <infra/iterator_range.hpp>
+#include <q/support/base.hpp>
+#include <q/detail/init_store.hpp>
+
+namespace cycfi::q
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // spsc_ring_buffer: a wait-free, single-producer, single-consumer FIFO
+   // for passing data between two threads, e.g. from the audio thread to a
+   // worker (UI or disk) thread, or vice versa.
+   //
+   // Exactly one thread may call the producer functions (push) and exactly
+   // one thread may call the consumer functions (pop, discard). The
+   // producer and consumer functions never block and never allocate. When
+   // the buffer is full, push rejects the excess elements; when the buffer
+   // is empty, pop returns nothing. The return values tell how many
+   // elements were actually pushed or popped.
+   //
+   // Like the ring_buffer, the storage has a size that is a power of 2 for
+   // efficient indexing. The write and read positions are kept in separate
+   // cache lines to avoid false sharing between the producer and consumer.
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T, typename Storage = std::vector<T>>
+   class spsc_ring_buffer
+   {
+   public:
+
+      static_assert(std::is_trivially_copyable<T>::value,
+         "Error: T must be trivially copyable");
+
+      using value_type = T;
+      using storage_type = Storage;
+
+      static constexpr std::size_t cache_line_size = 64;
+
+                        explicit spsc_ring_buffer();
+                        explicit spsc_ring_buffer(std::size_t size);
+                        spsc_ring_buffer(spsc_ring_buffer const& rhs) = delete;
+      spsc_ring_buffer& operator=(spsc_ring_buffer const& rhs) = delete;
+
+      std::size_t       capacity() const;
+      std::size_t       size() const;
+      bool              empty() const;
+
+      // Producer
+      bool              push(T const& val);
+      std::size_t       push(T const* data, std::size_t n);
+                        template <typename U>
+      std::size_t       push(iterator_range<U*> block);
+      std::size_t       write_available() const;
+
+      // Consumer
+      bool              pop(T& val);
+      std::size_t       pop(T* out, std::size_t n);
+                        template <typename U>
+      std::size_t       pop(iterator_range<U*> out);
+      std::size_t       discard(std::size_t n);
+      std::size_t       read_available() const;
+
+   private:
+
+      // The positions are free running counters. The element at position i
+      // is stored at _data[i & _mask].
+
+      // Producer cache line
+      alignas(cache_line_size)
+      std::atomic<std::size_t>   _write_pos;
+      std::size_t                _read_pos_cache;  // Producer's view
+
+      // Consumer cache line
+      alignas(cache_line_size)
+      std::atomic<std::size_t>   _read_pos;
+      std::size_t                _write_pos_cache; // Consumer's view
+
+      alignas(cache_line_size)
+      std::size_t                _mask;
+      Storage                    _data;
+   };
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Implementation
+   ////////////////////////////////////////////////////////////////////////////
+   template <typename T, typename Storage>
+   inline spsc_ring_buffer<T, Storage>::spsc_ring_buffer()
+    : _write_pos(0)
+    , _read_pos_cache(0)
+    , _read_pos(0)
+    , _write_pos_cache(0)
+   {
+      static_assert(!detail::resizable_container<Storage>::value,
+         "Error: Not default constructible for resizable buffers");
+      detail::init_store(_data, _mask);
+   }
+
+   template <typename T, typename Storage>
+   inline spsc_ring_buffer<T, Storage>::spsc_ring_buffer(std::size_t size)
+    : _write_pos(0)
+    , _read_pos_cache(0)
+    , _read_pos(0)
+    , _write_pos_cache(0)
+   {
+      static_assert(detail::resizable_container<Storage>::value,
+         "Error: Can't be constructed with size. Storage has fixed size.");
+      detail::init_store(size, _data, _mask);
+   }
+
+   // Get the buffer's capacity (the maximum number of elements it can hold).
+   template <typename T, typename Storage>
+   inline std::size_t spsc_ring_buffer<T, Storage>::capacity() const
+   {
+      return _data.size();
+   }
+
+   // Get the number of elements in the buffer. The result is only a
+   // snapshot when called while the other thread is active.
+   template <typename T, typename Storage>
+   inline std::size_t spsc_ring_buffer<T, Storage>::size() const
+   {
+      auto const r = _read_pos.load(std::memory_order_acquire);
+      auto const w = _write_pos.load(std::memory_order_acquire);
+      return w - r;
+   }
+
+   // Returns true if the buffer is empty. The result is only a snapshot
+   // when called while the other thread is active.
+   template <typename T, typename Storage>
+   inline bool spsc_ring_buffer<T, Storage>::empty() const
+   {
+      return size() == 0;
+   }
+
+   // Producer: push an element. Returns false if the buffer is full.
+   template <typename T, typename Storage>
+   inline bool spsc_ring_buffer<T, Storage>::push(T const& val)
+   {
+      auto const w = _write_pos.load(std::memory_order_relaxed);
+      if (w - _read_pos_cache == capacity())
+      {
+         _read_pos_cache = _read_pos.load(std::memory_order_acquire);
+         if (w - _read_pos_cache == capacity())
+            return false;
+      }
+      _data[w & _mask] = val;
+      _write_pos.store(w + 1, std::memory_order_release);
+      return true;
+   }
+
+   // Producer: push up to n elements, in order, using at most two
+   // contiguous copies. Returns the number of elements actually pushed,
+   // which is less than n if the buffer does not have enough space.
+   template <typename T, typename Storage>
+   inline std::size_t
+   spsc_ring_buffer<T, Storage>::push(T const* data, std::size_t n)
+   {
+      auto const w = _write_pos.load(std::memory_order_relaxed);
+      if (capacity() - (w - _read_pos_cache) < n)
+         _read_pos_cache = _read_pos.load(std::memory_order_acquire);
+      n = std::min(n, capacity() - (w - _read_pos_cache));
+
+      auto const start = w & _mask;
+      auto const first = std::min(n, capacity() - start);
+      auto dest = _data.data();
+      std::copy(data, data + first, dest + start);
+      std::copy(data + first, data + n, dest);
+
+      _write_pos.store(w + n, std::memory_order_release);
+      return n;
+   }
+
+   // Producer: push a block of elements. See push(data, n) above.
+   template <typename T, typename Storage>
+   template <typename U>
+   inline std::size_t
+   spsc_ring_buffer<T, Storage>::push(iterator_range<U*> block)
+   {
+      return push(block.begin(), block.end() - block.begin());
+   }
+
+   // Producer: get the number of elements that can be pushed.
+   template <typename T, typename Storage>
+   inline std::size_t spsc_ring_buffer<T, Storage>::write_available() const
+   {
+      auto const w = _write_pos.load(std::memory_order_relaxed);
+      return capacity() - (w - _read_pos.load(std::memory_order_acquire));
+   }
+
+   // Consumer: pop an element. Returns false if the buffer is empty.
+   template <typename T, typename Storage>
+   inline bool spsc_ring_buffer<T, Storage>::pop(T& val)
+   {
+      auto const r = _read_pos.load(std::memory_order_relaxed);
+      if (r == _write_pos_cache)
+      {
+         _write_pos_cache = _write_pos.load(std::memory_order_acquire);
+         if (r == _write_pos_cache)
+            return false;
+      }
+      val = _data[r & _mask];
+      _read_pos.store(r + 1, std::memory_order_release);
+      return true;
+   }
+
+   // Consumer: pop up to n elements, in order, using at most two contiguous
+   // copies. Returns the number of elements actually popped, which is less
+   // than n if the buffer does not have enough elements.
+   template <typename T, typename Storage>
+   inline std::size_t
+   spsc_ring_buffer<T, Storage>::pop(T* out, std::size_t n)
+   {
+      auto const r = _read_pos.load(std::memory_order_relaxed);
+      if (_write_pos_cache - r < n)
+         _write_pos_cache = _write_pos.load(std::memory_order_acquire);
+      n = std::min(n, _write_pos_cache - r);
+
+      auto const start = r & _mask;
+      auto const first = std::min(n, capacity() - start);
+      auto src = _data.data();
+      out = std::copy(src + start, src + start + first, out);
+      std::copy(src, src + (n - first), out);
+
+      _read_pos.store(r + n, std::memory_order_release);
+      return n;
+   }
+
+   // Consumer: pop a block of elements. See pop(out, n) above.
+   template <typename T, typename Storage>
+   template <typename U>
+   inline std::size_t
+   spsc_ring_buffer<T, Storage>::pop(iterator_range<U*> out)
+   {
+      return pop(out.begin(), out.end() - out.begin());
+   }
+
+   // Consumer: drop up to n elements. Returns the number of elements
+   // actually dropped.
+   template <typename T, typename Storage>
+   inline std::size_t spsc_ring_buffer<T, Storage>::discard(std::size_t n)
+   {
+      auto const r = _read_pos.load(std::memory_order_relaxed);
+      if (_write_pos_cache - r < n)
+         _write_pos_cache = _write_pos.load(std::memory_order_acquire);
+      n = std::min(n, _write_pos_cache - r);
+      _read_pos.store(r + n, std::memory_order_release);
+      return n;
+   }
+
+   // Consumer: get the number of elements that can be popped.
+   template <typename T, typename Storage>
+   inline std::size_t spsc_ring_buffer<T, Storage>::read_available() const
+   {
+      auto const r = _read_pos.load(std::memory_order_relaxed);
+      return _write_pos.load(std::memory_order_acquire) - r;
+   }
+}
+
+#endif
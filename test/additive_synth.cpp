@@ -0,0 +1,144 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+
+#include <q/support/literals.hpp>
+#include <q/synth/additive_synth.hpp>
+#include <cmath>
+#include <vector>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+constexpr auto sps = 48000;
+constexpr std::size_t partials = 256;
+constexpr std::size_t block = 64;
+
+TEST_CASE("Test_poly_sin_2pi")
+{
+   for (int i = -5000; i <= 5000; ++i)
+   {
+      auto x = i / 10000.0f;
+      REQUIRE(q::poly_sin_2pi(x) == Approx(std::sin(2_pi * double(x))).margin(2e-7));
+   }
+}
+
+TEST_CASE("Test_additive_synth_sawtooth")
+{
+   // A band limited sawtooth: harmonic k with amplitude 1/k. Only the
+   // harmonics below Nyquist are rendered.
+   constexpr double f0 = 1000.0;
+   auto synth = q::additive_synth<partials>{ sps };
+   synth.harmonics(q::frequency(f0));
+   for (std::size_t k = 0; k != partials; ++k)
+      synth.partial_amplitude(k, 1.0f / (k + 1));
+   CHECK(synth.active_partials() == 24);
+
+   std::vector<float> out(sps);
+   for (std::size_t i = 0; i < out.size(); i += block)
+      synth.render(out.data() + i, block);
+
+   // After the first block (the amplitudes ramp up from 0). The phase
+   // increments are rounded to float, like the synth's. The rotations are
+   // accurate to about 1e-7 radians per sample (1e-3 Hz), so the phases
+   // drift slowly from the reference's.
+   double max_error = 0.0;
+   for (std::size_t i = block; i != out.size(); ++i)
+   {
+      double y = 0.0;
+      for (std::size_t k = 1; k * f0 < sps / 2; ++k)
+         y += std::sin(2_pi * double(float(k * f0 / sps)) * (i + 1)) / k;
+      max_error = std::max(max_error, std::abs(out[i] - y));
+   }
+   CHECK(max_error < 3e-3);
+
+   // Higher notes render fewer partials
+   synth.harmonics(5_kHz);
+   CHECK(synth.active_partials() == 8);
+   synth.harmonics(30_kHz);
+   CHECK(synth.active_partials() == 0);
+   synth.render(out.data(), block);
+   for (std::size_t i = 0; i != block; ++i)
+      REQUIRE(out[i] == 0.0f);
+}
+
+TEST_CASE("Test_additive_synth_updates")
+{
+   // The frequencies and amplitudes change every block. The frequencies
+   // change without phase discontinuities, and the amplitudes ramp
+   // linearly over the block.
+   constexpr std::size_t n = 16;
+   auto synth = q::additive_synth<partials>{ sps };
+   std::vector<double> phase(n, 0.0), freq(n), amp(n, 0.0);
+   std::vector<float> out(block);
+
+   double max_error = 0.0;
+   for (std::size_t b = 0; b != 500; ++b)
+   {
+      std::vector<double> prev_amp = amp;
+      for (std::size_t k = 0; k != n; ++k)
+      {
+         freq[k] = 100.0 * (k + 1) * (1.0 + 0.05 * std::sin(b * 0.1 + k));
+         amp[k] = 0.05 * (1.0 + std::cos(b * 0.07 * (k + 1)));
+         synth.partial_frequency(k, q::frequency(freq[k]));
+         synth.partial_amplitude(k, amp[k]);
+      }
+      synth.render(out.data(), block);
+
+      for (std::size_t i = 0; i != block; ++i)
+      {
+         double y = 0.0;
+         for (std::size_t k = 0; k != n; ++k)
+         {
+            // The phase increment is rounded to float, like the synth's
+            phase[k] += 2_pi * double(float(freq[k] / sps));
+            auto a = prev_amp[k] + (amp[k] - prev_amp[k]) * (i + 1) / block;
+            y += a * std::sin(phase[k]);
+         }
+         max_error = std::max(max_error, std::abs(out[i] - y));
+      }
+   }
+   CHECK(max_error < 1e-4);
+}
+
+TEST_CASE("Test_additive_synth_cull")
+{
+   auto synth = q::additive_synth<partials>{ sps };
+   synth.partial_frequency(0, 1_kHz);
+   synth.partial_amplitude(0, 1.0f);
+   synth.partial_frequency(100, 20_kHz);
+   synth.partial_amplitude(100, 1.0f);
+   CHECK(synth.active_partials() == 104);
+
+   std::vector<float> out(block);
+   synth.render(out.data(), block);
+
+   // Partial 100 goes above Nyquist, and is silenced immediately
+   synth.partial_frequency(100, 25_kHz);
+   CHECK(synth.active_partials() == 8);
+   synth.render(out.data(), block);
+   for (std::size_t i = 0; i != block; ++i)
+   {
+      auto y = std::sin(2_pi * double(1000.0 * (block + i + 1) / sps));
+      REQUIRE(out[i] == Approx(y).margin(1e-4));
+   }
+
+   // And ramps up again from 0 when it comes back
+   synth.partial_frequency(100, 12_kHz);
+   CHECK(synth.active_partials() == 104);
+   synth.render(out.data(), block);
+   CHECK(std::abs(out[0]) < 1.1f);
+
+   // Silent partials are not rendered
+   synth.partial_amplitude(100, 0.0f);
+   synth.render(out.data(), block);
+   CHECK(synth.active_partials() == 8);
+
+   synth.reset();
+   synth.partial_amplitude(0, 0.0f);
+   CHECK(synth.active_partials() == 0);
+}
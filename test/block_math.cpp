@@ -0,0 +1,148 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+
+#include <q/support/literals.hpp>
+#include <q/support/block_math.hpp>
+#include <cmath>
+#include <vector>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+// Relative error, in units of float epsilon (about 2 ulp)
+double rel_error(float y, double ref)
+{
+   return std::abs(y - ref) / std::abs(ref) / 1.1920929e-7;
+}
+
+// n values evenly spaced in [lo, hi]
+std::vector<float> linspace(double lo, double hi, std::size_t n)
+{
+   std::vector<float> x(n);
+   for (std::size_t i = 0; i != n; ++i)
+      x[i] = lo + (hi - lo) * i / (n - 1);
+   return x;
+}
+
+TEST_CASE("Test_poly_exp")
+{
+   for (auto x : linspace(-126, 127, 100001))
+      REQUIRE(rel_error(q::poly_pow2(x), std::exp2(double(x))) < 2.0);
+   for (auto x : linspace(-87, 88, 100001))
+      REQUIRE(rel_error(q::poly_exp(x), std::exp(double(x))) < 2.0);
+
+   // Clamped out of range
+   CHECK(q::poly_exp(-1000.0f) > 0.0f);
+   CHECK(std::isfinite(q::poly_exp(1000.0f)));
+   CHECK(q::poly_pow2(0.0f) == 1.0f);
+   CHECK(q::poly_pow2(10.0f) == 1024.0f);
+}
+
+TEST_CASE("Test_poly_log")
+{
+   for (auto x : linspace(-125.5, 127.5, 100001))
+   {
+      auto a = std::exp2(double(x));
+      REQUIRE(rel_error(q::poly_log2(a), std::log2(double(float(a)))) < 2.0);
+      REQUIRE(rel_error(q::poly_log10(a), std::log10(double(float(a)))) < 2.0);
+   }
+
+   // Near 1, where the result is near 0
+   for (auto x : linspace(0.5, 2.0, 100001))
+   {
+      REQUIRE(q::poly_log2(x) == Approx(std::log2(double(x))).margin(2e-7));
+      REQUIRE(q::poly_log10(x) == Approx(std::log10(double(x))).margin(1e-7));
+   }
+
+   CHECK(q::poly_log2(1.0f) == 0.0f);
+   CHECK(q::poly_log2(8.0f) == 3.0f);
+   CHECK(q::poly_log2(0.0f) == -126.0f);
+   CHECK(q::poly_log2(-1.0f) == -126.0f);
+}
+
+TEST_CASE("Test_poly_sin_cos")
+{
+   for (auto x : linspace(-2_pi, 2_pi, 100001))
+   {
+      REQUIRE(q::poly_sin(x) == Approx(std::sin(double(x))).margin(1e-6));
+      REQUIRE(q::poly_cos(x) == Approx(std::cos(double(x))).margin(1e-6));
+   }
+
+   // The error grows with |x|
+   for (auto x : linspace(-1000, 1000, 100001))
+   {
+      REQUIRE(q::poly_sin(x) == Approx(std::sin(double(x))).margin(2e-4));
+      REQUIRE(q::poly_cos(x) == Approx(std::cos(double(x))).margin(2e-4));
+   }
+}
+
+TEST_CASE("Test_poly_tanh")
+{
+   for (auto x : linspace(-10, 10, 100001))
+   {
+      auto ref = std::tanh(double(x));
+      if (x != 0.0f)
+         REQUIRE(rel_error(q::poly_tanh(x), ref) < 2.0);
+   }
+   CHECK(q::poly_tanh(0.0f) == 0.0f);
+   CHECK(q::poly_tanh(20.0f) == 1.0f);
+   CHECK(q::poly_tanh(-20.0f) == -1.0f);
+   CHECK(q::poly_tanh(1e30f) == 1.0f);
+}
+
+TEST_CASE("Test_poly_decibel")
+{
+   for (auto db : linspace(-120, 24, 100001))
+      REQUIRE(rel_error(q::poly_db2a(db), std::pow(10.0, db / 20.0)) < 10.0);
+
+   for (auto x : linspace(-120, 24, 100001))
+   {
+      auto a = float(std::pow(10.0, x / 20.0));
+      REQUIRE(q::poly_a2db(a) == Approx(20 * std::log10(double(a))).margin(1e-5));
+   }
+
+   // Round trip
+   for (auto db : linspace(-120, 24, 1001))
+      REQUIRE(q::poly_a2db(q::poly_db2a(db)) == Approx(db).margin(2e-5));
+
+   CHECK(q::poly_db2a(0.0f) == 1.0f);
+   CHECK(q::poly_a2db(1.0f) == 0.0f);
+}
+
+TEST_CASE("Test_block_math")
+{
+   // The block functions compute the same as the scalar functions, for
+   // any length (the vectorized loops have a scalar epilogue), and in place
+   auto x = linspace(-10, 10, 1037);
+   std::vector<float> y(x.size()), in_place;
+
+   auto check = [&](auto block_f, auto f)
+   {
+      for (std::size_t n : { 0, 1, 3, 8, 17, 1037 })
+      {
+         std::fill(y.begin(), y.end(), -1.0f);
+         block_f(x.data(), y.data(), n);
+         for (std::size_t i = 0; i != x.size(); ++i)
+            REQUIRE(y[i] == (i < n? f(x[i]) : -1.0f));
+      }
+      in_place = x;
+      block_f(in_place.data(), in_place.data(), in_place.size());
+      for (std::size_t i = 0; i != x.size(); ++i)
+         REQUIRE(in_place[i] == f(x[i]));
+   };
+
+   check(q::block::pow2, q::poly_pow2);
+   check(q::block::exp, q::poly_exp);
+   check(q::block::log2, q::poly_log2);
+   check(q::block::log10, q::poly_log10);
+   check(q::block::sin, q::poly_sin);
+   check(q::block::cos, q::poly_cos);
+   check(q::block::tanh, q::poly_tanh);
+   check(q::block::db2a, q::poly_db2a);
+   check(q::block::a2db, q::poly_a2db);
+}
@@ -175,6 +175,56 @@ TEST_CASE("Test_db_conversion_accuracy")
    }
 }
 
+TEST_CASE("Test_float_db_conversion")
+{
+   // Accurate to float precision over the full range, including beyond
+   // +-120 dB
+   for (int i = -7580; i <= 7640; ++i)
+   {
+      auto db = i / 10.0f;
+      INFO("dB: " << db);
+      REQUIRE_THAT(q::from_db(db),
+         Catch::Matchers::WithinRel(std::pow(10.0, db / 20.0), 5e-6)
+      );
+   }
+
+   for (int i = -1260; i <= 1270; ++i)
+   {
+      auto a = float(std::exp2(i / 10.0));
+      INFO("a: " << a);
+      REQUIRE(q::to_db(a) == Approx(20 * std::log10(double(a))).margin(1e-4));
+   }
+
+   CHECK(q::to_db(1.0f) == 0.0f);
+   CHECK(q::from_db(0.0f) == 1.0f);
+   CHECK(q::to_db(0.0f) == Approx(-758.6f).margin(0.1));
+   CHECK(q::from_db(-1000.0f) > 0.0f);
+
+   // Round trip
+   for (int i = -1200; i <= 240; ++i)
+   {
+      auto db = i / 10.0f;
+      REQUIRE(q::to_db(q::from_db(db)) == Approx(db).margin(2e-5));
+   }
+
+   // The block conversions are the same as the scalar conversions
+   std::vector<float> a(1001), db(a.size()), y(a.size());
+   for (std::size_t i = 0; i != a.size(); ++i)
+      a[i] = 1e-6f + i * 0.01f;
+
+   q::to_db(a.data(), db.data(), db.size());
+   for (std::size_t i = 0; i != a.size(); ++i)
+      REQUIRE(db[i] == q::to_db(a[i]));
+
+   q::from_db(db.data(), y.data(), y.size());
+   for (std::size_t i = 0; i != a.size(); ++i)
+      REQUIRE(y[i] == q::from_db(db[i]));
+
+   // In place
+   q::from_db(db.data(), db.data(), db.size());
+   CHECK(db == y);
+}
+
 TEST_CASE("Test_decibel_speed")
 {
    // This is here to prevent dead-code elimination
@@ -241,6 +291,25 @@ TEST_CASE("Test_decibel_speed")
       CHECK(duration.count() > 0);
    }
 
+   {
+      std::vector<float> in(1023), out(1023);
+      for (int i = 1; i < 1024; ++i)
+         in[i-1] = float(i);
+
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int j = 0; j < 1024; ++j)
+      {
+         q::to_db(in.data(), out.data(), out.size());
+         accu += out[j % 1023];
+      }
+
+      auto elapsed = std::chrono::high_resolution_clock::now() - start;
+      auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+
+      std::cout << "to_db(in, out, n) elapsed (ns): " << float(duration.count()) / (1024*1023) << std::endl;
+      CHECK(duration.count() > 0);
+   }
+
    {
       auto start = std::chrono::high_resolution_clock::now();
 
@@ -261,6 +330,25 @@ TEST_CASE("Test_decibel_speed")
       CHECK(duration.count() > 0);
    }
 
+   {
+      std::vector<float> in(1200), out(1200);
+      for (int i = 0; i < 1200; ++i)
+         in[i] = float(i) / 10;
+
+      auto start = std::chrono::high_resolution_clock::now();
+      for (int j = 0; j < 1024; ++j)
+      {
+         q::from_db(in.data(), out.data(), out.size());
+         accu += out[j % 1200];
+      }
+
+      auto elapsed = std::chrono::high_resolution_clock::now() - start;
+      auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+
+      std::cout << "from_db(in, out, n) elapsed (ns): " << float(duration.count()) / (1024*1200) << std::endl;
+      CHECK(duration.count() > 0);
+   }
+
    {
       auto start = std::chrono::high_resolution_clock::now();
 
@@ -0,0 +1,170 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/envelope.hpp>
+#include <q/fx/envelope_bank.hpp>
+#include <vector>
+#include <cmath>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+namespace
+{
+   constexpr auto sps = 44100;
+   constexpr std::size_t num_channels = 4;
+
+   // Decaying tone bursts with different levels and frequencies per channel
+   std::vector<float> test_signal(std::size_t n, std::size_t ch = 0)
+   {
+      std::vector<float> in(n);
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         float t = i % 4000;
+         auto level = (0.2f + 0.2f * ch) * std::exp(-t * 0.001f);
+         in[i] = std::abs(level * std::sin(i * (0.01f + 0.013f * ch)));
+      }
+      return in;
+   }
+
+   // The block process may sum in a different order than the per-sample
+   // path, so we allow for round-off differences.
+   template <typename Env>
+   void check_block(Env env1, Env env2)
+   {
+      auto in = test_signal(20000);
+      std::vector<float> out(in.size());
+      for (std::size_t i = 0; i < in.size(); i += 100)
+         env1.process(in.data() + i, out.data() + i, 100);
+
+      bool same = true;
+      for (std::size_t i = 0; i != in.size(); ++i)
+      {
+         auto y = env2(in[i]);
+         same &= std::abs(out[i] - y) < 1e-3 * y + 1e-5;
+      }
+      CHECK(same);
+   }
+}
+
+TEST_CASE("Test_envelope_follower_block")
+{
+   check_block(
+      q::peak_envelope_follower{100_ms, sps}
+    , q::peak_envelope_follower{100_ms, sps}
+   );
+   check_block(
+      q::ar_envelope_follower{1_ms, 100_ms, sps}
+    , q::ar_envelope_follower{1_ms, 100_ms, sps}
+   );
+   check_block(
+      q::fast_envelope_follower{1.3_ms, sps}
+    , q::fast_envelope_follower{1.3_ms, sps}
+   );
+   check_block(
+      q::fast_ave_envelope_follower{1.3_ms, sps}
+    , q::fast_ave_envelope_follower{1.3_ms, sps}
+   );
+   check_block(
+      q::fast_rms_envelope_follower{1.3_ms, sps}
+    , q::fast_rms_envelope_follower{1.3_ms, sps}
+   );
+}
+
+TEST_CASE("Test_fast_rms_envelope_follower_db_block")
+{
+   auto env1 = q::fast_rms_envelope_follower_db{2_ms, sps};
+   auto env2 = q::fast_rms_envelope_follower_db{2_ms, sps};
+   auto in = test_signal(5000);
+   std::vector<q::decibel> out(in.size());
+   env1.process(in.data(), out.data(), in.size());
+   for (std::size_t i = 0; i != in.size(); ++i)
+      CHECK(out[i].rep == Approx(env2(in[i]).rep).margin(0.01));
+}
+
+namespace
+{
+   template <typename Bank, typename Env>
+   void check_bank(Bank bank, Env env)
+   {
+      std::vector<float> in[num_channels], out[num_channels];
+      std::vector<Env> envs(num_channels, env);
+      for (std::size_t ch = 0; ch != num_channels; ++ch)
+      {
+         in[ch] = test_signal(10000, ch);
+         out[ch].resize(in[ch].size());
+      }
+
+      constexpr std::size_t block_size = 64;
+      bool same = true, linked = true;
+      for (std::size_t i = 0; i < in[0].size(); i += block_size)
+      {
+         auto n = std::min(block_size, in[0].size() - i);
+         bank.process(
+            { in[0].data() + i, in[1].data() + i, in[2].data() + i, in[3].data() + i }
+          , { out[0].data() + i, out[1].data() + i, out[2].data() + i, out[3].data() + i }
+          , n
+         );
+
+         float max_y = 0.0f;
+         for (std::size_t j = 0; j != n; ++j)
+         {
+            for (std::size_t ch = 0; ch != num_channels; ++ch)
+            {
+               auto y = envs[ch](in[ch][i + j]);
+               same &= std::abs(out[ch][i + j] - y) < 1e-5;
+               if (j == n - 1)
+                  max_y = std::max(max_y, y);
+            }
+         }
+         linked &= std::abs(bank.linked() - max_y) < 1e-5;
+      }
+      CHECK(same);
+      CHECK(linked);
+   }
+}
+
+TEST_CASE("Test_envelope_follower_bank")
+{
+   check_bank(
+      q::peak_envelope_follower_bank<num_channels>{100_ms, sps}
+    , q::peak_envelope_follower{100_ms, sps}
+   );
+   check_bank(
+      q::ar_envelope_follower_bank<num_channels>{1_ms, 100_ms, sps}
+    , q::ar_envelope_follower{1_ms, 100_ms, sps}
+   );
+   check_bank(
+      q::fast_envelope_follower_bank<num_channels>{1.3_ms, sps}
+    , q::fast_envelope_follower{1.3_ms, sps}
+   );
+   check_bank(
+      q::fast_ave_envelope_follower_bank<num_channels>{1.3_ms, sps}
+    , q::fast_ave_envelope_follower{1.3_ms, sps}
+   );
+   check_bank(
+      q::fast_rms_envelope_follower_bank<num_channels>{1.3_ms, sps}
+    , q::fast_rms_envelope_follower{1.3_ms, sps}
+   );
+}
+
+TEST_CASE("Test_envelope_follower_bank_linked")
+{
+   auto bank = q::ar_envelope_follower_bank<2>{1_ms, 50_ms, sps};
+   auto left = test_signal(1000, 0);
+   auto right = test_signal(1000, 2);
+   std::vector<float> linked(left.size());
+   bank.process_linked({ left.data(), right.data() }, linked.data(), left.size());
+
+   auto env = q::ar_envelope_follower_bank<2>{1_ms, 50_ms, sps};
+   for (std::size_t i = 0; i != left.size(); ++i)
+   {
+      auto const& y = env({ left[i], right[i] });
+      CHECK(linked[i] == std::max(y[0], y[1]));
+   }
+}
@@ -0,0 +1,243 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+
+#include <q/support/literals.hpp>
+#include <q/synth/fm_synth.hpp>
+#include <q/synth/envelope_gen.hpp>
+#include <cmath>
+#include <vector>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+constexpr auto sps = 48000;
+constexpr std::size_t size = sps / 2;
+
+namespace
+{
+   // A single operator, with feedback
+   using single_op = q::fm_algorithm<0b1, 0b1>;
+
+   // 1 -> (0)
+   using two_op = q::fm_algorithm<0b01, 0b10, 0b00>;
+
+   double sin_cycles(double x)
+   {
+      return std::sin(2 * q::pi * x);
+   }
+
+   q::envelope_gen::config pad_envelope()
+   {
+      auto env = q::envelope_gen::config{};
+      env.attack_rate = 10_ms;
+      env.decay_rate = 100_ms;
+      env.release_rate = 50_ms;
+      return env;
+   }
+}
+
+TEST_CASE("Test_fm_algorithms")
+{
+   static_assert(q::fm4::algorithm_1::is_valid());
+   static_assert(q::fm4::algorithm_5::is_valid());
+   static_assert(q::fm4::algorithm_8::is_valid());
+
+   // Operator 0 may not modulate operator 1
+   static_assert(!q::fm_algorithm<0b01, 0b00, 0b01>::is_valid());
+
+   // No carriers
+   static_assert(!q::fm_algorithm<0b00, 0b10, 0b00>::is_valid());
+}
+
+TEST_CASE("Test_fm_single_operator")
+{
+   // Without feedback, a single operator is a sine times the envelope
+   auto config = q::fm_synth<single_op, 8>::config_type{};
+   config[0].envelope = pad_envelope();
+   config[0].level = 0.5f;
+   auto synth = q::fm_synth<single_op, 8>{ config, sps };
+
+   auto env = q::envelope_gen{ pad_envelope(), sps };
+   auto ph = q::phase_iterator{ q::midi::note_frequency(69), sps };
+
+   synth.note_on(69, 0.8f);
+   env.trigger(0.8f);
+
+   std::vector<float> out(size);
+   synth.render(out.data(), size / 2);
+   synth.note_off(69);
+   synth.render(out.data() + size / 2, size / 2);
+
+   for (std::size_t i = 0; i != size; ++i)
+   {
+      if (i == size / 2)
+         env.release();
+      auto e = env();
+      auto expected = std::sin(2_pi * ph._phase.rep / 4294967296.0) * e * 0.5f;
+      ++ph;
+      INFO("sample " << i);
+      REQUIRE(out[i] == Approx(expected).margin(1e-6));
+   }
+
+   // The release is done
+   CHECK(synth.active_voices() == 0);
+}
+
+TEST_CASE("Test_fm_two_operators")
+{
+   // Compare against a reference in double precision, with constant
+   // envelopes (fast attack, no decay)
+   auto flat = q::envelope_gen::config{};
+   flat.attack_rate = 0.01_ms;
+   flat.sustain_level = 0_dB;
+   flat.sustain_rate = 10000_s;
+
+   auto config = q::fm_synth<two_op, 8>::config_type{};
+   config[0].envelope = flat;
+   config[1].envelope = flat;
+   config[1].ratio = 2.0f;
+   config[1].level = 3.0f;       // modulation index
+   auto synth = q::fm_synth<two_op, 8>{ config, sps };
+   synth.note_on(57, 1.0f);
+
+   std::vector<float> out(size);
+   synth.render(out.data(), size);
+
+   // The flat envelopes still have the (very slow) sustain decay
+   auto env = q::envelope_gen{ flat, sps };
+   env.trigger(1.0f);
+
+   double f = q::as_double(q::midi::note_frequency(57)) / sps;
+   for (std::size_t i = 0; i != size; ++i)
+   {
+      double e = env();
+      auto mod = 3.0 * e * sin_cycles(2 * f * i);
+      auto expected = e * sin_cycles(f * i + mod / (2 * q::pi));
+      INFO("sample " << i);
+      REQUIRE(out[i] == Approx(expected).margin(1e-3));
+   }
+}
+
+TEST_CASE("Test_fm_feedback")
+{
+   auto flat = q::envelope_gen::config{};
+   flat.attack_rate = 0.01_ms;
+   flat.sustain_level = 0_dB;
+   flat.sustain_rate = 10000_s;
+
+   auto config = q::fm_synth<single_op, 8>::config_type{};
+   config[0].envelope = flat;
+   config[0].feedback = 1.5f;
+   auto synth = q::fm_synth<single_op, 8>{ config, sps };
+   synth.note_on(60, 1.0f);
+
+   std::vector<float> out(size);
+   synth.render(out.data(), size);
+
+   // The output is a sine modulated by the average of its last two
+   // outputs
+   auto env = q::envelope_gen{ flat, sps };
+   env.trigger(1.0f);
+
+   double f = q::as_double(q::midi::note_frequency(60)) / sps;
+   double y1 = 0, y2 = 0;
+   double max_diff = 0;
+   for (std::size_t i = 0; i != size; ++i)
+   {
+      double e = env();
+      auto expected = e * sin_cycles(f * i + 1.5 * (y1 + y2) / 2 / (2 * q::pi));
+      max_diff = std::max(max_diff, std::abs(out[i] - expected));
+      y2 = y1;
+      y1 = out[i];
+   }
+   CHECK(max_diff < 1e-3);
+
+   // Feedback adds harmonics: the waveform is no longer a pure sine
+   double sin_diff = 0;
+   for (std::size_t i = 0; i != size; ++i)
+      sin_diff = std::max(sin_diff, std::abs(out[i] - sin_cycles(f * i)));
+   CHECK(sin_diff > 0.1);
+}
+
+TEST_CASE("Test_fm_polyphony")
+{
+   using synth_type = q::fm_synth<q::fm4::algorithm_5, 16>;
+   auto config = synth_type::config_type{};
+   for (auto& op : config)
+      op.envelope = pad_envelope();
+   config[1].ratio = 3.0f;
+   config[3].ratio = 0.5f;
+   config[3].feedback = 0.5f;
+   auto synth = synth_type{ config, sps };
+
+   std::vector<float> out(256);
+   for (int k = 0; k != 16; ++k)
+   {
+      synth.note_on(40 + k, 0.5f);
+      synth.render(out.data(), out.size());
+   }
+   CHECK(synth.active_voices() == 16);
+
+   // Steal the oldest (key 40)
+   synth.note_on(90, 0.5f);
+   CHECK(synth.active_voices() == 16);
+   synth.render(out.data(), out.size());
+   for (auto s : out)
+      REQUIRE(std::abs(s) < 16.0f);
+
+   // Retrigger
+   synth.note_on(90, 0.9f);
+   CHECK(synth.active_voices() == 16);
+
+   synth.all_notes_off();
+   for (int i = 0; i != 200; ++i)
+      synth.render(out.data(), out.size());
+   CHECK(synth.active_voices() == 0);
+   for (auto s : out)
+      REQUIRE(s == 0.0f);
+
+   synth.note_on(60, 0.5f);
+   synth.all_sounds_off();
+   CHECK(synth.active_voices() == 0);
+}
+
+TEST_CASE("Test_fm_voice_stealing_click")
+{
+   // Sustained low notes on all voices, at full amplitude
+   auto flat = q::envelope_gen::config{};
+   flat.attack_rate = 0.01_ms;
+   flat.sustain_level = 0_dB;
+   flat.sustain_rate = 10000_s;
+
+   constexpr std::size_t voices = 8;
+   auto config = q::fm_synth<single_op, voices>::config_type{};
+   config[0].envelope = flat;
+   auto synth = q::fm_synth<single_op, voices>{ config, sps };
+
+   double max_step = 0;
+   for (std::size_t k = 0; k != voices; ++k)
+   {
+      synth.note_on(36 + k, 1.0f);
+      max_step += 2_pi * q::as_double(q::midi::note_frequency(36 + k)) / sps;
+   }
+
+   std::vector<float> out(1000);
+   synth.render(out.data(), out.size());
+   auto prev = out.back();
+
+   // Steal the oldest voice (key 36, a third of a cycle into its phase).
+   // The output has no jump larger than the slope of the sines.
+   synth.note_on(37 + voices, 1.0f);
+   max_step += 2_pi * q::as_double(q::midi::note_frequency(37 + voices)) / sps;
+   synth.render(out.data(), out.size());
+   for (auto s : out)
+   {
+      REQUIRE(std::abs(s - prev) < max_step);
+      prev = s;
+   }
+}
@@ -0,0 +1,75 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/dynamic.hpp>
+#include <cmath>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+namespace
+{
+   // Compare the table against the direct computation from -130 dB to
+   // +50 dB. The interpolation error is well below 0.05 dB, except at
+   // hard knees with steep slopes, which are rounded within one table step.
+   template <typename Processor>
+   void check_table(
+      q::gain_table<Processor> const& table
+    , Processor const& proc
+    , q::decibel makeup
+    , float eps = 0.006f)
+   {
+      for (float db = -130; db < 50; db += 0.0137f)
+      {
+         auto env = std::pow(10.0f, db / 20);
+         auto db_ = std::clamp(db, -120.41f, 48.16f);
+         auto env_ = std::pow(10.0f, db_ / 20);
+         auto expected = q::as_float(proc(q::decibel(env_)) + makeup);
+         INFO("env: " << db << " dB");
+         REQUIRE(table(env) == Approx(expected).epsilon(eps).margin(1e-5));
+      }
+   }
+}
+
+TEST_CASE("Test_gain_table_compressor")
+{
+   auto comp = q::compressor{ -18_dB, 1.0f / 4 };
+   auto table = q::gain_table<q::compressor>{ comp, 6_dB };
+   check_table(table, comp, 6_dB);
+
+   CHECK(table(0.0f) == Approx(q::as_float(6_dB)));
+   CHECK(table(-0.5f) == Approx(q::as_float(6_dB)));
+}
+
+TEST_CASE("Test_gain_table_soft_knee_compressor")
+{
+   auto comp = q::soft_knee_compressor{ -24_dB, 12_dB, 1.0f / 8 };
+   auto table = q::gain_table<q::soft_knee_compressor>{ comp };
+   check_table(table, comp, 0_dB);
+}
+
+TEST_CASE("Test_gain_table_expander")
+{
+   auto exp = q::expander{ -60_dB, 4.0f };
+   auto table = q::gain_table<q::expander>{ exp };
+   check_table(table, exp, 0_dB, 0.05f);
+}
+
+TEST_CASE("Test_gain_table_rebuild")
+{
+   auto table = q::gain_table<q::compressor>{ q::compressor{ -18_dB, 1.0f / 4 } };
+
+   auto comp = q::compressor{ -6_dB, 1.0f / 10 };
+   table.processor(comp);
+   CHECK(table.processor().threshold() == -6_dB);
+   check_table(table, comp, 0_dB);
+
+   table.makeup(12_dB);
+   CHECK(table.makeup() == 12_dB);
+   check_table(table, comp, 12_dB);
+}
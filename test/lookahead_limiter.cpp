@@ -0,0 +1,135 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/lookahead_limiter.hpp>
+#include <vector>
+#include <random>
+#include <cmath>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+namespace
+{
+   constexpr auto sps = 48000;
+
+   // Music-like test signal: tones with random bursts and transients
+   std::vector<float> test_signal(std::size_t n, unsigned seed)
+   {
+      auto rng = std::mt19937{seed};
+      auto dist = std::uniform_real_distribution<float>{-1.0f, 1.0f};
+      std::vector<float> in(n);
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         auto level = (i / 4000) % 3 + 0.5f;
+         in[i] = level * (0.6f * std::sin(i * 0.031f) + 0.4f * dist(rng));
+         if (i % 9973 == 0)
+            in[i] = 4.0f; // transient
+      }
+      return in;
+   }
+
+   float peak_level(std::vector<float> const& v)
+   {
+      float peak = 0.0f;
+      for (auto s : v)
+         peak = std::max(peak, std::abs(s));
+      return peak;
+   }
+
+   // Estimate the true peak by 8x oversampling using a long windowed
+   // sinc interpolator
+   float true_peak_level(std::vector<float> const& v)
+   {
+      constexpr int half = 32;
+      float peak = peak_level(v);
+      for (std::size_t i = half; i + half < v.size(); ++i)
+      {
+         for (int k = 1; k != 8; ++k)
+         {
+            double t = k / 8.0, y = 0;
+            for (int j = -half + 1; j <= half; ++j)
+            {
+               double x = t - j;
+               double w = 0.5 + 0.5 * std::cos(q::pi * x / (half + 1));
+               y += v[i + j] * w * std::sin(q::pi * x) / (q::pi * x);
+            }
+            peak = std::max(peak, float(std::abs(y)));
+         }
+      }
+      return peak;
+   }
+}
+
+TEST_CASE("Test_lookahead_limiter")
+{
+   auto const ceiling = -1_dB;
+   auto lim = q::lookahead_limiter{2_ms, 50_ms, sps, ceiling};
+   CHECK(lim.latency() == 96);
+
+   auto in = test_signal(sps, 1);
+   std::vector<float> out(in.size());
+
+   // Odd block sizes
+   for (std::size_t i = 0; i < in.size(); i += 113)
+      lim.process(in.data() + i, out.data() + i, std::min<std::size_t>(113, in.size() - i));
+
+   CHECK(peak_level(in) > 3.0f);
+   CHECK(peak_level(out) <= q::as_float(ceiling));
+   CHECK(q::as_float(lim.gain()) < 1.0f);
+
+   // Signal below the ceiling passes through unchanged (delayed)
+   auto lim2 = q::lookahead_limiter{2_ms, 50_ms, sps, ceiling};
+   std::vector<float> quiet(2000), quiet_out(2000);
+   for (std::size_t i = 0; i != quiet.size(); ++i)
+      quiet[i] = 0.5f * std::sin(i * 0.05f);
+   lim2.process(quiet.data(), quiet_out.data(), quiet.size());
+   for (std::size_t i = lim2.latency(); i != quiet.size(); ++i)
+      CHECK(quiet_out[i] == Approx(quiet[i - lim2.latency()]).margin(1e-6));
+}
+
+TEST_CASE("Test_lookahead_limiter_stereo_in_place")
+{
+   auto const ceiling = -0.5_dB;
+   auto lim = q::stereo_lookahead_limiter{1_ms, 20_ms, sps, ceiling};
+   auto left = test_signal(sps / 2, 2);
+   auto right = test_signal(sps / 2, 3);
+   for (auto& s : right)
+      s *= 0.25f; // quieter, but linked to the left channel
+
+   std::vector<float> right_in = right;
+   lim.process({ left.data(), right.data() }, { left.data(), right.data() }, left.size());
+
+   CHECK(peak_level(left) <= q::as_float(ceiling));
+   CHECK(peak_level(right) <= q::as_float(ceiling));
+
+   // Linked: the right channel is attenuated along with the left channel
+   CHECK(peak_level(right) < 0.8f * peak_level(right_in));
+}
+
+TEST_CASE("Test_lookahead_limiter_true_peak")
+{
+   // A near-Nyquist tone with inter-sample peaks above the sample peaks
+   std::vector<float> in(sps / 4);
+   for (std::size_t i = 0; i != in.size(); ++i)
+      in[i] = std::sin(i * q::pi * 0.5 + q::pi / 4) * (1.0f + 0.5f * ((i / 1000) % 2));
+   CHECK(true_peak_level(in) > 1.3f * peak_level(in));
+
+   auto const ceiling = -1_dB;
+   auto lim = q::lookahead_limiter{2_ms, 50_ms, sps, ceiling, true};
+   CHECK(lim.latency() == 96 + 4);
+   std::vector<float> out(in.size());
+   lim.process(in.data(), out.data(), in.size());
+
+   auto sp = q::lookahead_limiter{2_ms, 50_ms, sps, ceiling};
+   std::vector<float> sp_out(in.size());
+   sp.process(in.data(), sp_out.data(), in.size());
+
+   CHECK(true_peak_level(out) <= q::as_float(ceiling) * 1.01f);
+   CHECK(true_peak_level(sp_out) > q::as_float(ceiling) * 1.2f);
+}
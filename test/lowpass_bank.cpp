@@ -0,0 +1,118 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/lowpass_bank.hpp>
+#include <vector>
+#include <random>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+namespace
+{
+   constexpr auto sps = 44100;
+   constexpr std::size_t lanes = 16;
+   constexpr std::size_t size = 5000;
+
+   // Control signal-like test input: random steps with some noise
+   std::vector<float> test_signal(unsigned seed)
+   {
+      auto rng = std::mt19937{seed};
+      auto dist = std::uniform_real_distribution<float>{0.0f, 1.0f};
+      std::vector<float> in(size);
+      float level = 0.0f;
+      for (auto& s : in)
+      {
+         if (dist(rng) < 0.002f)
+            level = dist(rng);
+         s = level + 0.01f * dist(rng);
+      }
+      return in;
+   }
+
+   // Compare the bank against N scalar filters
+   template <typename Bank, typename Filter>
+   void check_bank(Bank& bank, std::vector<Filter>& filters)
+   {
+      std::vector<std::vector<float>> in;
+      for (std::size_t k = 0; k != lanes; ++k)
+         in.push_back(test_signal(k + 1));
+
+      for (std::size_t i = 0; i != size; ++i)
+      {
+         q::frame<lanes> s;
+         for (std::size_t k = 0; k != lanes; ++k)
+            s[k] = in[k][i];
+         auto const& y = bank(s);
+         for (std::size_t k = 0; k != lanes; ++k)
+            REQUIRE(y[k] == Approx(filters[k](s[k])).margin(1e-6));
+      }
+   }
+
+   q::frequency lane_frequency(std::size_t k)
+   {
+      return q::frequency(5.0 + 10.0 * k);
+   }
+}
+
+TEST_CASE("Test_leaky_integrator_bank")
+{
+   auto bank = q::leaky_integrator_bank<lanes>{};
+   std::vector<q::leaky_integrator> filters;
+   for (std::size_t k = 0; k != lanes; ++k)
+   {
+      bank.cutoff(k, lane_frequency(k), sps);
+      filters.emplace_back(lane_frequency(k), sps);
+   }
+   check_bank(bank, filters);
+}
+
+TEST_CASE("Test_one_pole_lowpass_bank")
+{
+   auto bank = q::one_pole_lowpass_bank<lanes>{ 10_Hz, sps };
+   std::vector<q::one_pole_lowpass> filters;
+   for (std::size_t k = 0; k != lanes; ++k)
+   {
+      bank.cutoff(k, lane_frequency(k), sps);
+      filters.emplace_back(lane_frequency(k), sps);
+   }
+   check_bank(bank, filters);
+}
+
+TEST_CASE("Test_dynamic_smoother_bank")
+{
+   auto bank = q::dynamic_smoother_bank<lanes>{ 10_Hz, sps };
+   std::vector<q::dynamic_smoother> filters;
+   for (std::size_t k = 0; k != lanes; ++k)
+   {
+      auto sense = 0.1f + 0.05f * k;
+      bank.base_frequency(k, lane_frequency(k), sps);
+      bank.sensitivity(k, sense);
+      filters.emplace_back(lane_frequency(k), sense, sps);
+   }
+   check_bank(bank, filters);
+}
+
+TEST_CASE("Test_lowpass_bank_process")
+{
+   auto in = test_signal(7);
+   std::vector<float> out1(size), out2(size), expected(size);
+
+   auto bank = q::dynamic_smoother_bank<2>{ 20_Hz, sps };
+   bank.base_frequency(1, 100_Hz, sps);
+   bank.process({ in.data(), in.data() }, { out1.data(), out2.data() }, size);
+
+   auto sm1 = q::dynamic_smoother{ 20_Hz, sps };
+   auto sm2 = q::dynamic_smoother{ 100_Hz, sps };
+   for (std::size_t i = 0; i != size; ++i)
+   {
+      REQUIRE(out1[i] == Approx(sm1(in[i])).margin(1e-6));
+      REQUIRE(out2[i] == Approx(sm2(in[i])).margin(1e-6));
+   }
+   CHECK(bank()[1] == out2[size-1]);
+}
@@ -0,0 +1,143 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/median.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <deque>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+namespace
+{
+   template <std::size_t N>
+   float sorted_median(std::array<float, N> p)
+   {
+      std::sort(p.begin(), p.end());
+      return p[N / 2];
+   }
+
+   // Brute force sliding quantile
+   struct reference_quantile
+   {
+      reference_quantile(std::size_t size, float q, float init)
+       : _window(size, init)
+       , _k(std::size_t(q * (size - 1) + 0.5f))
+      {}
+
+      float operator()(float s)
+      {
+         _window.pop_front();
+         _window.push_back(s);
+         std::vector<float> v(_window.begin(), _window.end());
+         std::nth_element(v.begin(), v.begin() + _k, v.end());
+         return v[_k];
+      }
+
+      std::deque<float> _window;
+      std::size_t _k;
+   };
+}
+
+TEST_CASE("Test_median_networks")
+{
+   auto rng = std::mt19937{1234};
+   auto dist = std::uniform_int_distribution<int>{-8, 8}; // Plenty of ties
+
+   for (int i = 0; i != 10000; ++i)
+   {
+      std::array<float, 5> p5;
+      std::array<float, 7> p7;
+      std::array<float, 9> p9;
+      for (auto& e : p5) e = dist(rng);
+      for (auto& e : p7) e = dist(rng);
+      for (auto& e : p9) e = dist(rng);
+
+      CHECK(q::median5f(p5) == sorted_median(p5));
+      CHECK(q::median7f(p7) == sorted_median(p7));
+      CHECK(q::median9f(p9) == sorted_median(p9));
+   }
+}
+
+TEST_CASE("Test_median_filters")
+{
+   auto rng = std::mt19937{5678};
+   auto dist = std::uniform_real_distribution<float>{-1.0f, 1.0f};
+
+   auto m5 = q::median5{};
+   auto m9 = q::median9{0.5f};
+   auto ref5 = reference_quantile{5, 0.5f, 0.0f};
+   auto ref9 = reference_quantile{9, 0.5f, 0.5f};
+
+   CHECK(m9() == 0.5f);
+   for (int i = 0; i != 1000; ++i)
+   {
+      auto s = dist(rng);
+      CHECK(m5(s) == ref5(s));
+      CHECK(m9(s) == ref9(s));
+   }
+}
+
+TEST_CASE("Test_moving_quantile")
+{
+   auto rng = std::mt19937{9012};
+   auto dist = std::uniform_int_distribution<int>{-50, 50};
+
+   for (std::size_t size : { 1, 2, 3, 10, 64, 101 })
+   {
+      for (float qt : { 0.0f, 0.1f, 0.5f, 0.9f, 1.0f })
+      {
+         auto mq = q::moving_quantile<float>{size, qt, 3.0f};
+         auto ref = reference_quantile{size, qt, 3.0f};
+         CHECK(mq() == 3.0f);
+
+         bool same = true;
+         for (int i = 0; i != 2000; ++i)
+         {
+            auto s = float(dist(rng));
+            same &= (mq(s) == ref(s));
+         }
+         CHECK(same);
+      }
+   }
+
+   // A size of 0 is the same as a size of 1
+   auto mq = q::moving_quantile<float>{std::size_t(0), 0.5f};
+   CHECK(mq.size() == 1);
+   CHECK(mq(5.0f) == 5.0f);
+   CHECK(mq(-2.0f) == -2.0f);
+
+   // q is clamped to [0, 1]: the minimum and the maximum
+   auto mq_lo = q::moving_quantile<float>{9, -0.1f};
+   auto mq_hi = q::moving_quantile<float>{9, 1.1f};
+   auto ref_lo = reference_quantile{9, 0.0f, 0.0f};
+   auto ref_hi = reference_quantile{9, 1.0f, 0.0f};
+   bool same = true;
+   for (int i = 0; i != 200; ++i)
+   {
+      auto s = float(dist(rng));
+      same &= (mq_lo(s) == ref_lo(s));
+      same &= (mq_hi(s) == ref_hi(s));
+   }
+   CHECK(same);
+}
+
+TEST_CASE("Test_moving_median")
+{
+   constexpr auto sps = 44100;
+   auto mm = q::moving_median<float>{1_ms, sps};
+   CHECK(mm.size() == 44);
+
+   // Impulsive noise is rejected
+   float y = 0.0f;
+   for (int i = 0; i != 1000; ++i)
+      y = mm((i % 10 == 0)? 100.0f : 1.0f);
+   CHECK(y == 1.0f);
+}
@@ -0,0 +1,170 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/moving_maximum.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace q = cycfi::q;
+
+namespace
+{
+   std::vector<float> random_signal(std::size_t n)
+   {
+      std::mt19937 gen{ 1234 };
+      std::uniform_real_distribution<float> dist{ -1.0f, 1.0f };
+      std::vector<float> in(n);
+      for (auto& s : in)
+         s = dist(gen);
+      return in;
+   }
+
+   // Brute force reference: extremum of (up to) the last n samples
+   template <typename Compare>
+   float reference(std::vector<float> const& in, std::size_t i, std::size_t n)
+   {
+      auto first = in.begin() + ((i+1 > n)? i+1-n : 0);
+      auto last = in.begin() + i + 1;
+      return *std::min_element(first, last, Compare{});
+   }
+}
+
+TEST_CASE("Test_moving_extremum")
+{
+   auto in = random_signal(2000);
+   for (std::size_t size : { 1, 2, 7, 64, 100 })
+   {
+      INFO("window size = " << size);
+      auto mmax = q::moving_maximum<float>{ size };
+      auto wmax = q::wedge_moving_maximum<float>{ size };
+      auto wmin = q::moving_minimum<float>{ size };
+
+      for (std::size_t i = 0; i != in.size(); ++i)
+      {
+         auto max_ = reference<std::greater<float>>(in, i, size);
+         auto min_ = reference<std::less<float>>(in, i, size);
+         CHECK(mmax(in[i]) == max_);
+         CHECK(wmax(in[i]) == max_);
+         CHECK(wmin(in[i]) == min_);
+      }
+      CHECK(wmax() == reference<std::greater<float>>(in, in.size()-1, size));
+      CHECK(wmin() == reference<std::less<float>>(in, in.size()-1, size));
+   }
+}
+
+TEST_CASE("Test_block_moving_extremum")
+{
+   auto in = random_signal(2000);
+   for (std::size_t size : { 1, 2, 7, 64, 100 })
+   {
+      INFO("window size = " << size);
+      constexpr std::size_t block_size = 64;
+      auto bmax = q::block_moving_maximum<float>{ size };
+      auto bmin = q::block_moving_minimum<float>{ size };
+      std::vector<float> max_out(in.size()), min_out(in.size());
+
+      // Varying block sizes, up to block_size
+      for (std::size_t i = 0, n = 1; i < in.size(); i += n, n = (n * 7) % block_size + 1)
+      {
+         n = std::min(n, in.size() - i);
+         bmax.process(in.data() + i, max_out.data() + i, n);
+         bmin.process(in.data() + i, min_out.data() + i, n);
+      }
+
+      for (std::size_t i = 0; i != in.size(); ++i)
+      {
+         CHECK(max_out[i] == reference<std::greater<float>>(in, i, size));
+         CHECK(min_out[i] == reference<std::less<float>>(in, i, size));
+      }
+      CHECK(bmax() == max_out.back());
+   }
+}
+
+TEST_CASE("Test_vhgw_per_sample")
+{
+   auto in = random_signal(500);
+   for (std::size_t size : { 1, 3, 16 })
+   {
+      auto vmin = q::block_moving_minimum<float>{ size };
+      for (std::size_t i = 0; i != in.size(); ++i)
+         CHECK(vmin(in[i]) == reference<std::less<float>>(in, i, size));
+   }
+}
+
+TEST_CASE("Test_moving_extremum_edge_cases")
+{
+   auto in = random_signal(100);
+
+   // An empty block leaves the state unchanged
+   auto bmax = q::block_moving_maximum<float>{ 8 };
+   bmax.process(in.data(), nullptr, 0);
+   CHECK(bmax(in[0]) == in[0]);
+
+   // A size of 0 is the same as a size of 1
+   auto vmax = q::block_moving_maximum<float>{ std::size_t(0) };
+   CHECK(vmax.size() == 1);
+   std::vector<float> out(in.size());
+   vmax.process(in.data(), out.data(), in.size());
+   CHECK(out == in);
+
+   // Same for the wedge
+   auto wmin = q::wedge_moving_minimum<float>{ std::size_t(0) };
+   CHECK(wmin.size() == 1);
+   for (auto s : in)
+      REQUIRE(wmin(s) == s);
+}
+
+namespace
+{
+   template <typename F>
+   double time_it(F&& f)
+   {
+      auto start = std::chrono::high_resolution_clock::now();
+      f();
+      auto stop = std::chrono::high_resolution_clock::now();
+      return std::chrono::duration<double, std::nano>(stop - start).count();
+   }
+}
+
+TEST_CASE("Test_moving_extremum_benchmark")
+{
+   constexpr std::size_t block_size = 256;
+   auto in = random_signal(block_size * 4000);
+   std::vector<float> out(in.size());
+   auto const n = double(in.size());
+
+   for (std::size_t size : { 16, 256, 4096 })
+   {
+      auto mmax = q::moving_maximum<float>{ size };
+      auto wmax = q::wedge_moving_maximum<float>{ size };
+      auto bmax = q::block_moving_maximum<float>{ size };
+
+      auto t_brookes = time_it(
+         [&]{ for (std::size_t i = 0; i != in.size(); ++i) out[i] = mmax(in[i]); });
+      auto check = out;
+      auto t_wedge = time_it(
+         [&]{ for (std::size_t i = 0; i != in.size(); ++i) out[i] = wmax(in[i]); });
+      CHECK(out == check);
+      auto t_vhgw = time_it(
+         [&]
+         {
+            for (std::size_t i = 0; i != in.size(); i += block_size)
+               bmax.process(in.data() + i, out.data() + i, block_size);
+         });
+      CHECK(out == check);
+
+      std::cout
+         << "moving maximum, window size " << size << " (ns/sample): "
+         << "brookes: " << t_brookes / n
+         << ", wedge: " << t_wedge / n
+         << ", van Herk-Gil-Werman: " << t_vhgw / n
+         << std::endl;
+   }
+}
@@ -0,0 +1,132 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/moving_stats.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <cmath>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+namespace
+{
+   struct reference_stats
+   {
+      double mean = 0, variance = 0, rms = 0, skewness = 0, kurtosis = 0;
+   };
+
+   // Two-pass reference statistics in double precision
+   reference_stats compute_stats(float const* first, float const* last)
+   {
+      reference_stats r;
+      double n = last - first;
+      for (auto p = first; p != last; ++p)
+         r.mean += *p;
+      r.mean /= n;
+
+      double m2 = 0, m3 = 0, m4 = 0, sq = 0;
+      for (auto p = first; p != last; ++p)
+      {
+         double d = *p - r.mean;
+         m2 += d * d;
+         m3 += d * d * d;
+         m4 += d * d * d * d;
+         sq += double(*p) * *p;
+      }
+      r.variance = m2 / n;
+      r.rms = std::sqrt(sq / n);
+      r.skewness = (m2 > 0)? std::sqrt(n) * m3 / std::pow(m2, 1.5) : 0;
+      r.kurtosis = (m2 > 0)? n * m4 / (m2 * m2) - 3 : 0;
+      return r;
+   }
+
+   std::vector<float> test_signal(std::size_t n)
+   {
+      // Skewed noise with a DC offset and a slowly changing level
+      auto rng = std::mt19937{1234};
+      auto dist = std::exponential_distribution<float>{2.0f};
+      std::vector<float> in(n);
+      for (std::size_t i = 0; i != n; ++i)
+         in[i] = 0.5f + dist(rng) * (1.0f + 0.5f * std::sin(i * 0.001f));
+      return in;
+   }
+}
+
+TEST_CASE("Test_moving_stats")
+{
+   constexpr std::size_t size = 256;
+   auto in = test_signal(10000);
+   auto ms = q::moving_stats{size};
+
+   for (std::size_t i = 0; i != in.size(); ++i)
+   {
+      ms(in[i]);
+      CHECK(ms.count() == std::min(i + 1, size));
+
+      if (i % 97 == 0 || i == in.size() - 1)
+      {
+         auto first = in.data() + (i + 1 - ms.count());
+         auto r = compute_stats(first, in.data() + i + 1);
+         CHECK(ms.mean() == Approx(r.mean).epsilon(1e-4));
+         CHECK(ms.variance() == Approx(r.variance).epsilon(1e-3).margin(1e-6));
+         CHECK(ms.rms() == Approx(r.rms).epsilon(1e-4));
+         CHECK(ms.skewness() == Approx(r.skewness).epsilon(1e-2).margin(1e-3));
+         CHECK(ms.kurtosis() == Approx(r.kurtosis).epsilon(1e-2).margin(1e-2));
+      }
+   }
+}
+
+TEST_CASE("Test_moving_stats_block")
+{
+   constexpr std::size_t size = 100;
+   auto in = test_signal(3000);
+
+   for (std::size_t block_size : { 1, 7, 64, 100, 333 })
+   {
+      auto ms1 = q::moving_stats{size};
+      auto ms2 = q::moving_stats{size};
+
+      for (std::size_t i = 0; i < in.size(); i += block_size)
+      {
+         auto n = std::min(block_size, in.size() - i);
+         ms1.process(in.data() + i, n);
+         for (std::size_t j = 0; j != n; ++j)
+            ms2(in[i + j]);
+
+         CHECK(ms1.count() == ms2.count());
+         CHECK(ms1.mean() == ms2.mean());
+         CHECK(ms1.variance() == ms2.variance());
+         CHECK(ms1.skewness() == ms2.skewness());
+      }
+   }
+}
+
+TEST_CASE("Test_moving_stats_long_run")
+{
+   // A large DC offset with small variations. Raw power sums in float
+   // would lose the variance entirely.
+   auto ms = q::moving_stats{10_ms, 48000};
+   CHECK(ms.size() == 480);
+
+   auto rng = std::mt19937{5678};
+   auto dist = std::uniform_real_distribution<float>{-0.01f, 0.01f};
+   std::vector<float> window;
+   for (std::size_t i = 0; i != 2'000'000; ++i)
+   {
+      auto s = 100.0f + dist(rng);
+      ms(s);
+      if (i >= 2'000'000 - ms.size())
+         window.push_back(s);
+   }
+
+   auto r = compute_stats(window.data(), window.data() + window.size());
+   CHECK(ms.mean() == Approx(r.mean).epsilon(1e-5));
+   CHECK(ms.variance() == Approx(r.variance).epsilon(0.05));
+}
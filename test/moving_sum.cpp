@@ -6,6 +6,11 @@
 #define CATCH_CONFIG_MAIN
 #include <infra/catch.hpp>
 #include <q/fx/moving_sum.hpp>
+#include <q/fx/moving_average.hpp>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <iostream>
 
 namespace q = cycfi::q;
 
@@ -76,3 +81,174 @@ TEST_CASE("Test_moving_sum_resize")
    CHECK(ms() == 20);
 }
 
+
+TEST_CASE("Test_moving_sum_block")
+{
+   constexpr std::size_t size = 100;
+   std::vector<float> in(1000);
+   for (std::size_t i = 0; i != in.size(); ++i)
+      in[i] = std::sin(i * 0.1f) + (i % 7) * 0.25f;
+
+   // Block sizes smaller and larger than the window
+   for (std::size_t block_size : { 1, 13, 64, 100, 257, 1000 })
+   {
+      auto ms1 = q::moving_sum{size};
+      auto ms2 = q::moving_sum{size};
+      auto sms = q::stable_moving_sum{size};
+      auto ma = q::moving_average{size};
+      std::vector<float> out(in.size()), sout(in.size()), aout(in.size());
+
+      for (std::size_t i = 0; i < in.size(); i += block_size)
+      {
+         auto n = std::min(block_size, in.size() - i);
+         ms1.process(in.data() + i, out.data() + i, n);
+         sms.process(in.data() + i, sout.data() + i, n);
+         ma.process(in.data() + i, aout.data() + i, n);
+      }
+
+      for (std::size_t i = 0; i != in.size(); ++i)
+      {
+         auto expected = ms2(in[i]);
+         CHECK(out[i] == Approx(expected).margin(1e-4));
+         CHECK(sout[i] == Approx(expected).margin(1e-4));
+         CHECK(aout[i] == Approx(expected / size).margin(1e-6));
+      }
+      CHECK(ms1() == Approx(ms2()).margin(1e-4));
+   }
+
+   // In-place (in == out), with blocks smaller and larger than the window
+   for (std::size_t block_size : { 32, 257 })
+   {
+      auto ms1 = q::moving_sum{size};
+      auto ms2 = q::moving_sum{size};
+      auto sms = q::stable_moving_sum{size};
+      auto ma = q::moving_average{size};
+      auto io = in, sio = in, aio = in;
+
+      for (std::size_t i = 0; i < in.size(); i += block_size)
+      {
+         auto n = std::min(block_size, in.size() - i);
+         ms1.process(io.data() + i, io.data() + i, n);
+         sms.process(sio.data() + i, sio.data() + i, n);
+         ma.process(aio.data() + i, aio.data() + i, n);
+      }
+
+      for (std::size_t i = 0; i != in.size(); ++i)
+      {
+         auto expected = ms2(in[i]);
+         CHECK(io[i] == Approx(expected).margin(1e-4));
+         CHECK(sio[i] == Approx(expected).margin(1e-4));
+         CHECK(aio[i] == Approx(expected / size).margin(1e-6));
+      }
+   }
+}
+
+TEST_CASE("Test_moving_sum_size_0")
+{
+   // A size of 0 is clamped to 1: the moving sum is the latest sample
+   float in[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+   float out[8] = {};
+
+   auto ms = q::moving_sum{0};
+   CHECK(ms.size() == 1);
+   ms.process(in, out, 8);
+   for (int i = 0; i != 8; ++i)
+      CHECK(out[i] == in[i]);
+
+   auto sms = q::stable_moving_sum{16};
+   sms.resize(0);
+   CHECK(sms.size() == 1);
+   sms.process(in, out, 8);
+   for (int i = 0; i != 8; ++i)
+      CHECK(out[i] == in[i]);
+   CHECK(sms(9.0f) == 9.0f);
+}
+
+TEST_CASE("Test_moving_sum_block_int")
+{
+   auto ms1 = q::basic_moving_sum<int>{10};
+   auto ms2 = q::basic_moving_sum<int>{10};
+   int in[64], out[64];
+   for (int i = 0; i != 64; ++i)
+      in[i] = (i * 37) % 11;
+   ms1.process(in, out, 64);
+   for (int i = 0; i != 64; ++i)
+      CHECK(out[i] == ms2(in[i]));
+}
+
+TEST_CASE("Test_moving_sum_drift")
+{
+   // Run a long stream of noisy data with a DC offset. The plain float
+   // moving sum drifts. The stable (resync) moving sum does not.
+   constexpr std::size_t size = 1000;
+   constexpr std::size_t block_size = 256;
+   constexpr std::size_t blocks = 40000; // ~10M samples
+
+   auto ms = q::moving_sum{size};
+   auto sms = q::stable_moving_sum{size};
+   std::uint32_t seed = 1;
+   std::vector<float> in(block_size), out(block_size);
+   std::vector<float> window(size, 0.0f);
+   std::size_t wpos = 0;
+
+   for (std::size_t b = 0; b != blocks; ++b)
+   {
+      for (auto& s : in)
+      {
+         seed = seed * 1664525u + 1013904223u;
+         s = 1000.0f + (seed >> 8) * (1.0f / (1 << 24));
+         window[wpos] = s;
+         wpos = (wpos + 1) % size;
+      }
+      ms.process(in.data(), out.data(), block_size);
+      sms.process(in.data(), out.data(), block_size);
+   }
+
+   double exact = 0.0;
+   for (auto s : window)
+      exact += s;
+
+   auto err = std::abs(ms() - exact);
+   auto serr = std::abs(sms() - exact);
+   CHECK(serr < 1.0);
+   CHECK(serr < err);
+
+   // The block process keeps the running sum in double precision, like
+   // operator()(s). Only the round-off of the prefix sums within each
+   // block accumulates.
+   CHECK(err < 0.5);
+}
+
+TEST_CASE("Test_moving_sum_block_speed")
+{
+   constexpr std::size_t size = 1024;
+   constexpr std::size_t block_size = 256;
+   constexpr std::size_t blocks = 20000;
+
+   std::vector<float> in(block_size), out(block_size);
+   for (std::size_t i = 0; i != block_size; ++i)
+      in[i] = std::sin(i * 0.1f);
+
+   auto ms1 = q::moving_sum{size};
+   auto start = std::chrono::high_resolution_clock::now();
+   for (std::size_t b = 0; b != blocks; ++b)
+      for (std::size_t i = 0; i != block_size; ++i)
+         out[i] = ms1(in[i]);
+   auto mid = std::chrono::high_resolution_clock::now();
+
+   auto ms2 = q::moving_sum{size};
+   for (std::size_t b = 0; b != blocks; ++b)
+      ms2.process(in.data(), out.data(), block_size);
+   auto stop = std::chrono::high_resolution_clock::now();
+
+   std::chrono::duration<double, std::nano> scalar = mid - start;
+   std::chrono::duration<double, std::nano> block = stop - mid;
+   auto const samples = double(block_size * blocks);
+
+   std::cout
+      << "moving_sum: per sample: " << scalar.count() / samples
+      << " ns/sample, block: " << block.count() / samples
+      << " ns/sample" << std::endl;
+
+   CHECK(ms1() == Approx(ms2()).margin(1e-3));
+}
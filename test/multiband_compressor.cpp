@@ -0,0 +1,134 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/multiband_compressor.hpp>
+#include <vector>
+#include <random>
+#include <cmath>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+namespace
+{
+   constexpr auto sps = 48000;
+
+   std::vector<float> noise(std::size_t n, unsigned seed)
+   {
+      auto rng = std::mt19937{seed};
+      auto dist = std::uniform_real_distribution<float>{-0.5f, 0.5f};
+      std::vector<float> in(n);
+      for (auto& s : in)
+         s = dist(rng);
+      return in;
+   }
+
+   std::vector<float> sine(std::size_t n, q::frequency f, float level)
+   {
+      std::vector<float> in(n);
+      auto w = 2 * q::pi * q::as_double(f) / sps;
+      for (std::size_t i = 0; i != n; ++i)
+         in[i] = level * std::sin(w * i);
+      return in;
+   }
+
+   // Sine amplitude from the RMS level (the sample peaks of high
+   // frequency tones may miss the crests)
+   float level(float const* p, std::size_t n)
+   {
+      double sum = 0;
+      for (std::size_t i = 0; i != n; ++i)
+         sum += p[i] * p[i];
+      return std::sqrt(2 * sum / n);
+   }
+}
+
+TEST_CASE("Test_multiband_compressor_phase_coherent_sum")
+{
+   // With no compression, the bands sum to the cascade of the crossover
+   // allpass responses.
+   auto in = noise(20000, 1);
+   std::vector<float> out(in.size());
+
+   auto comp = q::multiband_compressor<3>{{ 200_Hz, 2_kHz }, 10_ms, sps};
+   comp.process(in.data(), out.data(), in.size());
+
+   auto ap1 = q::linkwitz_riley_allpass{ 200_Hz, sps };
+   auto ap2 = q::linkwitz_riley_allpass{ 2_kHz, sps };
+   for (std::size_t i = 0; i != in.size(); ++i)
+      CHECK(out[i] == Approx(ap2(ap1(in[i]))).margin(1e-4));
+}
+
+TEST_CASE("Test_multiband_compressor_flat_response")
+{
+   auto comp = q::multiband_compressor<4>{{ 150_Hz, 1_kHz, 5_kHz }, 10_ms, sps};
+   for (auto f : { 50_Hz, 150_Hz, 400_Hz, 1_kHz, 2500_Hz, 5_kHz, 12_kHz })
+   {
+      auto in = sine(24000, f, 0.5f);
+      std::vector<float> out(in.size());
+      comp.process(in.data(), out.data(), in.size());
+      auto l = level(out.data() + 12000, 12000);
+      CHECK(l == Approx(0.5f).epsilon(0.01));
+   }
+}
+
+TEST_CASE("Test_multiband_compressor_band_compression")
+{
+   auto comp = q::multiband_compressor<3>{{ 300_Hz, 3_kHz }, 10_ms, sps};
+   comp.compressor(0, -30_dB, 6_dB, 1.0f / 4);
+
+   // Loud low frequency tone: compressed
+   {
+      auto in = sine(24000, 80_Hz, 0.5f);
+      std::vector<float> out(in.size());
+      comp.process(in.data(), out.data(), in.size());
+      CHECK(comp.gain(0) < -10_dB);
+      CHECK(level(out.data() + 12000, 12000) < 0.2f);
+   }
+
+   // Loud high frequency tone: not compressed
+   {
+      auto in = sine(24000, 8_kHz, 0.5f);
+      std::vector<float> out(in.size());
+      comp.process(in.data(), out.data(), in.size());
+      CHECK(q::as_float(comp.gain(2)) == Approx(1.0f));
+      CHECK(level(out.data() + 12000, 12000) == Approx(0.5f).epsilon(0.01));
+   }
+
+   // Makeup gain
+   comp.makeup(2, 6_dB);
+   {
+      auto in = sine(24000, 8_kHz, 0.25f);
+      std::vector<float> out(in.size());
+      comp.process(in.data(), out.data(), in.size());
+      CHECK(level(out.data() + 12000, 12000) == Approx(0.5f).epsilon(0.01));
+   }
+}
+
+TEST_CASE("Test_multiband_compressor_block_sizes")
+{
+   auto in = noise(10000, 2);
+   std::vector<float> out1(in.size()), out2(in.size());
+
+   auto comp1 = q::multiband_compressor<5>{{ 100_Hz, 500_Hz, 2_kHz, 8_kHz }, 5_ms, sps};
+   auto comp2 = comp1;
+   for (std::size_t b = 0; b != 5; ++b)
+   {
+      comp1.compressor(b, -20_dB, 3_dB, 0.5f);
+      comp2.compressor(b, -20_dB, 3_dB, 0.5f);
+   }
+
+   comp1.process(in.data(), out1.data(), in.size());
+   for (std::size_t i = 0; i < in.size(); i += 37)
+   {
+      auto n = std::min<std::size_t>(37, in.size() - i);
+      comp2.process(in.data() + i, out2.data() + i, n);
+   }
+   for (std::size_t i = 0; i != in.size(); ++i)
+      REQUIRE(out1[i] == out2[i]);
+}
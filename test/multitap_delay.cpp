@@ -0,0 +1,159 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/delay.hpp>
+#include <q/fx/multitap_delay.hpp>
+#include <q/fx/feedback_delay_network.hpp>
+#include <vector>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+namespace
+{
+   std::vector<float> test_signal(std::size_t n)
+   {
+      std::vector<float> in(n);
+      for (std::size_t i = 0; i != n; ++i)
+         in[i] = std::sin(i * 0.05f) + 0.25f * std::sin(i * 0.71f);
+      return in;
+   }
+}
+
+TEST_CASE("Test_multitap_delay")
+{
+   float const delays[] = { 1.0f, 7.5f, 33.25f, 100.0f };
+   auto mtap = q::multitap_delay<4>{128};
+   auto ref = q::delay{128};
+   for (std::size_t k = 0; k != 4; ++k)
+      mtap.tap(k, delays[k]);
+
+   CHECK(mtap.tap(2) == Approx(33.25f));
+
+   auto in = test_signal(1000);
+   for (auto s : in)
+   {
+      auto taps = mtap(s);
+      for (std::size_t k = 0; k != 4; ++k)
+         CHECK(taps[k] == Approx(ref(delays[k] - 1.0f)).margin(1e-6));
+      ref.push(s);
+   }
+}
+
+TEST_CASE("Test_multitap_delay_block")
+{
+   float const delays[] = { 3.0f, 10.7f, 64.0f };
+   auto mtap1 = q::multitap_delay<3>{100};
+   auto mtap2 = q::multitap_delay<3>{100};
+   for (std::size_t k = 0; k != 3; ++k)
+   {
+      mtap1.tap(k, delays[k]);
+      mtap2.tap(k, delays[k]);
+   }
+
+   constexpr std::size_t block_size = 37;
+   auto in = test_signal(block_size * 20);
+   std::vector<float> out[3];
+   for (auto& o : out)
+      o.resize(in.size());
+
+   for (std::size_t i = 0; i < in.size(); i += block_size)
+   {
+      mtap1.process(
+         in.data() + i
+       , { out[0].data() + i, out[1].data() + i, out[2].data() + i }
+       , block_size
+      );
+   }
+
+   for (std::size_t i = 0; i != in.size(); ++i)
+   {
+      auto taps = mtap2(in[i]);
+      for (std::size_t k = 0; k != 3; ++k)
+         CHECK(out[k][i] == Approx(taps[k]).margin(1e-6));
+   }
+}
+
+TEST_CASE("Test_feedback_matrices_are_lossless")
+{
+   std::array<float, 8> x = { 0.3f, -1.0f, 0.5f, 0.25f, 0.0f, 2.0f, -0.7f, 0.1f };
+   float energy = 0.0f;
+   for (auto e : x)
+      energy += e * e;
+
+   auto hh = x;
+   q::householder_matrix{}(hh);
+   auto hd = x;
+   q::hadamard_matrix{}(hd);
+
+   float hh_energy = 0.0f, hd_energy = 0.0f;
+   for (std::size_t i = 0; i != x.size(); ++i)
+   {
+      hh_energy += hh[i] * hh[i];
+      hd_energy += hd[i] * hd[i];
+   }
+   CHECK(hh_energy == Approx(energy));
+   CHECK(hd_energy == Approx(energy));
+}
+
+TEST_CASE("Test_feedback_delay_network_decay")
+{
+   constexpr auto sps = 48000.0f;
+   auto fdn = q::feedback_delay_network<4, q::hadamard_matrix>{
+      {{ 1031, 1327, 1523, 1871 }}
+   };
+   fdn.decay(500_ms, sps);
+
+   // Impulse
+   fdn(1.0f);
+
+   auto rms = [&](std::size_t n)
+   {
+      float sum = 0.0f;
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         auto y = fdn(0.0f);
+         sum += y * y;
+      }
+      return std::sqrt(sum / n);
+   };
+
+   // Energy after 0.5s is roughly 60dB below the energy at the start.
+   auto start = rms(sps / 10);
+   rms(sps * 3 / 10);
+   auto end = rms(sps / 10);
+   CHECK(start > 0.0f);
+   CHECK(20 * std::log10(end / start) == Approx(-48.0f).margin(6.0f));
+}
+
+TEST_CASE("Test_feedback_delay_network_zero_length")
+{
+   // A length of 0 is the same as a length of 1
+   auto fdn0 = q::feedback_delay_network<2>{{{ 0, 3 }}};
+   auto fdn1 = q::feedback_delay_network<2>{{{ 1, 3 }}};
+   fdn0.decay(100_ms, 1000.0f);
+   fdn1.decay(100_ms, 1000.0f);
+   for (int i = 0; i != 100; ++i)
+   {
+      auto s = (i == 0)? 1.0f : 0.0f;
+      REQUIRE(fdn0(s) == fdn1(s));
+   }
+}
+
+TEST_CASE("Test_feedback_delay_network_no_decay")
+{
+   // There is no feedback until decay is called. An impulse comes out once
+   // per line, after each line's length.
+   auto fdn = q::feedback_delay_network<2>{{{ 3, 5 }}};
+   std::vector<float> out;
+   for (int i = 0; i != 20; ++i)
+      out.push_back(fdn((i == 0)? 1.0f : 0.0f));
+
+   for (int i = 0; i != 20; ++i)
+      CHECK(out[i] == ((i == 3 || i == 5)? 1.0f : 0.0f));
+}
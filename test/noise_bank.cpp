@@ -0,0 +1,208 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+
+#include <q/support/literals.hpp>
+#include <q/synth/noise_bank.hpp>
+#include <q/fft/fft.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+constexpr auto sps = 48000;
+constexpr std::size_t lanes = 4;
+
+template <typename Bank>
+std::vector<std::vector<float>> render(Bank& bank, std::size_t n)
+{
+   std::vector<std::vector<float>> out(Bank::num_lanes, std::vector<float>(n));
+   typename Bank::out_channels ch;
+   for (std::size_t k = 0; k != Bank::num_lanes; ++k)
+      ch[k] = out[k].data();
+   bank.render(ch, n);
+   return out;
+}
+
+// Power per octave in dB, from an averaged power spectrum
+std::vector<double> octave_power(std::vector<float> const& x)
+{
+   constexpr std::size_t n = 4096;
+   std::vector<double> power(n / 2, 0.0);
+   std::vector<double> data(n * 2);
+   for (std::size_t start = 0; start + n <= x.size(); start += n)
+   {
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         auto w = 0.5 - 0.5 * std::cos(2_pi * i / n);
+         data[i * 2] = x[start + i] * w;
+         data[i * 2 + 1] = 0.0;
+      }
+      q::fft<n>(data.data());
+      for (std::size_t i = 1; i != n / 2; ++i)
+         power[i] += data[i * 2] * data[i * 2] + data[i * 2 + 1] * data[i * 2 + 1];
+   }
+
+   // Octaves starting from bin 4 (about 47 Hz) up to about 12 kHz
+   std::vector<double> octaves;
+   for (std::size_t lo = 4; lo * 2 <= n / 4; lo *= 2)
+   {
+      double sum = 0.0;
+      for (std::size_t i = lo; i != lo * 2; ++i)
+         sum += power[i];
+      octaves.push_back(10 * std::log10(sum));
+   }
+   return octaves;
+}
+
+TEST_CASE("Test_philox")
+{
+   // Known answers of Philox-4x32-10 (Random123)
+   auto a = q::detail::philox4x32({ 0, 0, 0, 0 }, 0, 0);
+   CHECK(a[0] == 0x6627e8d5);
+   CHECK(a[1] == 0xe169c58d);
+   CHECK(a[2] == 0xbc57ac4c);
+   CHECK(a[3] == 0x9b00dbd8);
+
+   auto b = q::detail::philox4x32(
+      { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, 0xffffffff, 0xffffffff);
+   CHECK(b[0] == 0x408f276d);
+   CHECK(b[1] == 0x41c83b0e);
+   CHECK(b[2] == 0xa20bc7c6);
+   CHECK(b[3] == 0x6d5451fd);
+}
+
+TEST_CASE("Test_white_noise_bank")
+{
+   constexpr std::size_t n = 1 << 16;
+   auto bank = q::white_noise_bank<lanes>{ 1234 };
+   auto out = render(bank, n);
+   CHECK(bank.position() == n);
+
+   // Uniform in [-1, 1): mean 0, variance 1/3
+   for (auto const& x : out)
+   {
+      double sum = 0.0, sum2 = 0.0;
+      for (auto s : x)
+      {
+         REQUIRE(s >= -1.0f);
+         REQUIRE(s < 1.0f);
+         sum += s;
+         sum2 += s * s;
+      }
+      CHECK(std::abs(sum / n) < 0.01);
+      CHECK(sum2 / n == Approx(1.0 / 3).epsilon(0.01));
+   }
+
+   // The lanes are uncorrelated, and so are the samples
+   for (std::size_t k = 1; k != lanes; ++k)
+   {
+      double corr = 0.0, lag = 0.0;
+      for (std::size_t i = 1; i != n; ++i)
+      {
+         corr += out[0][i] * out[k][i];
+         lag += out[k][i] * out[k][i-1];
+      }
+      CHECK(std::abs(corr / n) < 0.01);
+      CHECK(std::abs(lag / n) < 0.01);
+   }
+
+   // The per-sample frames are the same as the block render
+   auto bank2 = q::white_noise_bank<lanes>{ 1234 };
+   for (std::size_t i = 0; i != 1000; ++i)
+   {
+      auto const& y = bank2();
+      for (std::size_t k = 0; k != lanes; ++k)
+         REQUIRE(y[k] == out[k][i]);
+   }
+
+   // Seeking reproduces the streams from any position
+   bank2.seek(30000);
+   auto out2 = render(bank2, 5000);
+   for (std::size_t k = 0; k != lanes; ++k)
+      for (std::size_t i = 0; i != 5000; ++i)
+         REQUIRE(out2[k][i] == out[k][30000 + i]);
+
+   // Any block size gives the same streams
+   auto bank4 = q::white_noise_bank<lanes>{ 1234 };
+   std::size_t i = 0;
+   for (std::size_t size = 1; i + size <= 5000; i += size, size = (size * 3) % 17 + 1)
+   {
+      auto out4 = render(bank4, size);
+      for (std::size_t k = 0; k != lanes; ++k)
+         for (std::size_t j = 0; j != size; ++j)
+            REQUIRE(out4[k][j] == out[k][i + j]);
+   }
+   CHECK(bank4.position() == i);
+
+   // Different seeds give different streams
+   auto bank3 = q::white_noise_bank<lanes>{ 1235 };
+   auto out3 = render(bank3, 1000);
+   std::size_t same = 0;
+   for (std::size_t i = 0; i != 1000; ++i)
+      same += out3[0][i] == out[0][i];
+   CHECK(same < 5);
+}
+
+TEST_CASE("Test_pink_noise_bank")
+{
+   constexpr std::size_t n = 1 << 18;
+   auto bank = q::pink_noise_bank<lanes>{ sps, 1 };
+   auto out = render(bank, n);
+
+   // -3dB/octave: about the same power in each octave (the filter is
+   // within +/- 1.2 dB, from 47 Hz to 12 kHz)
+   for (auto const& x : out)
+   {
+      auto octaves = octave_power(x);
+      auto [min, max] = std::minmax_element(octaves.begin(), octaves.end());
+      CHECK(*max - *min < 3.0);
+   }
+
+   // The per-sample frames are the same as the block render, within
+   // rounding (the filters are computed in a different order)
+   auto bank2 = q::pink_noise_bank<lanes>{ sps, 1 };
+   for (std::size_t i = 0; i != 10000; ++i)
+   {
+      auto const& y = bank2();
+      for (std::size_t k = 0; k != lanes; ++k)
+         REQUIRE(y[k] == Approx(out[k][i]).margin(1e-6));
+   }
+}
+
+TEST_CASE("Test_voss_mccartney_bank")
+{
+   constexpr std::size_t n = 1 << 18;
+   auto bank = q::voss_mccartney_bank<lanes>{ 7 };
+   auto out = render(bank, n);
+
+   // -3dB/octave, with the ripple of the Voss-McCartney algorithm
+   for (auto const& x : out)
+   {
+      for (auto s : x)
+      {
+         REQUIRE(s >= -1.0f);
+         REQUIRE(s < 1.0f);
+      }
+      auto octaves = octave_power(x);
+      auto [min, max] = std::minmax_element(octaves.begin(), octaves.end());
+      CHECK(*max - *min < 2.0);
+   }
+
+   // Seeking restores the exact state at any position
+   for (std::uint32_t pos : { 1u, 2u, 1000u, 65535u, 65536u, 100001u })
+   {
+      auto bank2 = q::voss_mccartney_bank<lanes>{ 7 };
+      bank2.seek(pos);
+      auto out2 = render(bank2, 5000);
+      for (std::size_t k = 0; k != lanes; ++k)
+         for (std::size_t i = 0; i != 5000; ++i)
+            REQUIRE(out2[k][i] == out[k][pos + i]);
+   }
+}
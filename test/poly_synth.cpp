@@ -0,0 +1,246 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/synth/poly_synth.hpp>
+#include <q/synth/square_synth.hpp>
+#include <q/synth/saw_synth.hpp>
+#include <q/synth/sin_synth.hpp>
+#include <vector>
+
+namespace q = cycfi::q;
+namespace midi = q::midi;
+using namespace q::literals;
+
+namespace
+{
+   constexpr auto sps = 48000;
+
+   auto const env_cfg = q::envelope_gen::config
+   {
+      10_ms       // attack rate
+    , 100_ms      // decay rate
+    , -12_dB      // sustain level
+    , 5_s         // sustain rate
+    , 50_ms       // release rate
+   };
+
+   midi::raw_message raw(std::uint8_t status, std::uint8_t data1, std::uint8_t data2)
+   {
+      return { std::uint32_t(status | (data1 << 8) | (data2 << 16)) };
+   }
+}
+
+TEST_CASE("Test_poly_synth_single_voice")
+{
+   // One voice is the same as a square_synth with an envelope_gen
+   auto synth = q::poly_synth<q::square_synth, 16>{ q::square, env_cfg, sps };
+   auto env = q::envelope_gen{ env_cfg, sps };
+   auto ph = q::phase_iterator{ midi::note_frequency(69), sps };
+
+   constexpr std::size_t size = 48000;
+   constexpr std::size_t note_on_time = 1000;
+   constexpr std::size_t note_off_time = 20000;
+   std::vector<float> out(size);
+
+   synth(midi::note_on{ 0, 69, 100 }, note_on_time);
+   synth.render(out.data(), note_off_time);
+   synth(midi::note_off{ 0, 69, 0 }, 0);
+   synth.render(out.data() + note_off_time, size - note_off_time);
+
+   for (std::size_t i = 0; i != size; ++i)
+   {
+      if (i == note_on_time)
+         env.trigger(100.0f / 128);
+      else if (i == note_off_time)
+         env.release();
+
+      float expected = 0.0f;
+      if (i >= note_on_time)
+         expected = q::square(ph++) * env();
+      REQUIRE(out[i] == Approx(expected).margin(1e-6));
+   }
+   CHECK(synth.active_voices() == 0);
+}
+
+TEST_CASE("Test_poly_synth_dispatch")
+{
+   auto synth = q::poly_synth<q::basic_square_synth, 8>{ q::basic_square, env_cfg, sps };
+   std::vector<float> out(256);
+
+   midi::dispatch(raw(midi::status::note_on, 60, 127), 100, synth);
+   midi::dispatch(raw(midi::status::note_on, 64, 127), 37, synth);
+   synth.render(out.data(), out.size());
+
+   // Sample accurate note-ons
+   for (std::size_t i = 0; i != 37; ++i)
+      REQUIRE(out[i] == 0.0f);
+   CHECK(out[37] != 0.0f);
+   CHECK(synth.active_voices() == 2);
+
+   // Note-on with zero velocity is a note-off
+   midi::dispatch(raw(midi::status::note_on, 60, 0), 0, synth);
+   midi::dispatch(raw(midi::status::note_off, 64, 0), 10, synth);
+   for (int i = 0; i != 100; ++i)
+      synth.render(out.data(), out.size());
+   CHECK(synth.active_voices() == 0);
+
+   // All sounds off
+   synth.note_on(60, 1.0f);
+   synth.note_on(62, 1.0f);
+   midi::dispatch(raw(midi::status::control_change, midi::cc::all_sounds_off, 0), 0, synth);
+   synth.render(out.data(), out.size());
+   CHECK(synth.active_voices() == 0);
+   for (auto s : out)
+      REQUIRE(s == 0.0f);
+}
+
+TEST_CASE("Test_poly_synth_voice_stealing")
+{
+   std::vector<float> out(4800);
+   auto release_all = [&](auto& synth, std::uint8_t from, std::uint8_t to)
+   {
+      for (auto key = from; key <= to; ++key)
+         synth.note_off(key);
+      for (int i = 0; i != 20; ++i)
+         synth.render(out.data(), out.size());
+   };
+
+   SECTION("Oldest")
+   {
+      auto synth = q::poly_synth<q::saw_synth, 8>{ q::saw, env_cfg, sps };
+      for (std::uint8_t key = 60; key != 68; ++key)
+      {
+         synth.note_on(key, 0.8f);
+         synth.render(out.data(), 64);
+      }
+      CHECK(synth.active_voices() == 8);
+
+      // Steals key 60, the oldest
+      synth.note_on(72, 0.8f);
+      CHECK(synth.active_voices() == 8);
+
+      release_all(synth, 60, 67);
+      CHECK(synth.active_voices() == 1);
+      release_all(synth, 72, 72);
+      CHECK(synth.active_voices() == 0);
+   }
+
+   SECTION("Quietest")
+   {
+      auto synth = q::poly_synth<q::saw_synth, 8>{
+         q::saw, env_cfg, sps, q::voice_stealing::quietest };
+      for (std::uint8_t key = 60; key != 68; ++key)
+         synth.note_on(key, (key == 63)? 0.1f : 0.8f);
+      synth.render(out.data(), out.size());
+
+      // Steals key 63, the quietest
+      synth.note_on(72, 0.8f);
+
+      release_all(synth, 60, 62);
+      release_all(synth, 64, 67);
+      CHECK(synth.active_voices() == 1);
+      release_all(synth, 63, 63);
+      CHECK(synth.active_voices() == 1);
+      release_all(synth, 72, 72);
+      CHECK(synth.active_voices() == 0);
+   }
+
+   SECTION("Retrigger")
+   {
+      auto synth = q::poly_synth<q::saw_synth, 8>{ q::saw, env_cfg, sps };
+      synth.note_on(60, 0.8f);
+      synth.note_on(60, 0.8f);
+      CHECK(synth.active_voices() == 1);
+   }
+}
+
+TEST_CASE("Test_poly_synth_voice_stealing_click")
+{
+   // Sustained low sine notes on all voices, at full amplitude
+   auto flat = q::envelope_gen::config{};
+   flat.attack_rate = 0.01_ms;
+   flat.sustain_level = 0_dB;
+   flat.sustain_rate = 10000_s;
+
+   constexpr std::size_t voices = 8;
+   auto synth = q::poly_synth<q::sin_synth, voices>{ q::sin, flat, sps };
+
+   double max_step = 0;
+   for (std::size_t k = 0; k != voices; ++k)
+   {
+      synth.note_on(36 + k, 1.0f);
+      max_step += 2_pi * q::as_double(q::midi::note_frequency(36 + k)) / sps;
+   }
+
+   std::vector<float> out(1000);
+   synth.render(out.data(), out.size());
+   auto prev = out.back();
+
+   // Steal the oldest voice. The output has no jump larger than the slope
+   // of the sines.
+   synth.note_on(37 + voices, 1.0f);
+   max_step += 2_pi * q::as_double(q::midi::note_frequency(37 + voices)) / sps;
+   synth.render(out.data(), out.size());
+   for (auto s : out)
+   {
+      REQUIRE(std::abs(s - prev) < max_step);
+      prev = s;
+   }
+}
+
+TEST_CASE("Test_poly_synth_queue_overflow")
+{
+   // Overflow the event queue with note-on/note-off pairs. The events are
+   // still applied in order, so no voice is left stuck.
+   using synth_type = q::poly_synth<q::basic_square_synth, 8>;
+   auto synth = synth_type{ q::basic_square, env_cfg, sps };
+   std::vector<float> out(4800);
+
+   // The leading note-on makes the queue fill up right after a note-on,
+   // so the first overflowing event is the matching note-off.
+   constexpr std::size_t pairs = synth_type::queue_size;
+   synth(midi::note_on{ 0, 30, 100 }, 0);
+   for (std::size_t i = 0; i != pairs; ++i)
+   {
+      auto key = std::uint8_t(40 + i % 48);
+      synth(midi::note_on{ 0, key, 100 }, i * 4 + 1);
+      synth(midi::note_off{ 0, key, 0 }, i * 4 + 3);
+   }
+   synth(midi::note_off{ 0, 30, 0 }, pairs * 4);
+   for (int i = 0; i != 20; ++i)
+      synth.render(out.data(), out.size());
+   CHECK(synth.active_voices() == 0);
+
+   // A full queue with a new event that is earlier than all the queued
+   // events
+   for (std::size_t i = 0; i != synth_type::queue_size; ++i)
+      synth(midi::note_on{ 0, 60, 100 }, 1000);
+   synth(midi::note_off{ 0, 60, 0 }, 2000);
+   synth(midi::note_on{ 0, 64, 100 }, 10);
+   for (int i = 0; i != 5; ++i)
+      synth.render(out.data(), out.size());
+
+   // Key 60 is released, key 64 is still sounding
+   CHECK(synth.active_voices() == 1);
+}
+
+TEST_CASE("Test_poly_synth_many_voices")
+{
+   // Voices in the upper groups
+   auto synth = q::poly_synth<q::saw_synth, 128>{ q::saw, env_cfg, sps };
+   std::vector<float> out(4800);
+   for (std::uint8_t key = 0; key != 128; ++key)
+      synth.note_on(key, 0.5f);
+   synth.render(out.data(), out.size());
+   CHECK(synth.active_voices() == 128);
+
+   synth.all_notes_off();
+   for (int i = 0; i != 20; ++i)
+      synth.render(out.data(), out.size());
+   CHECK(synth.active_voices() == 0);
+}
@@ -0,0 +1,114 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/utility/ring_buffer.hpp>
+
+namespace q = cycfi::q;
+
+TEST_CASE("Test_ring_buffer_push")
+{
+   auto rb = q::ring_buffer<int>{8};
+   for (int i = 0; i != 20; ++i)
+      rb.push(i);
+
+   CHECK(rb.size() == 8);
+   CHECK(rb.front() == 19);
+   CHECK(rb.back() == 12);
+   for (int i = 0; i != 8; ++i)
+      CHECK(rb[i] == 19-i);
+
+   rb.pop_front();
+   CHECK(rb.front() == 18);
+   rb.push(100);
+   CHECK(rb.front() == 100);
+   CHECK(rb[1] == 18);
+}
+
+TEST_CASE("Test_ring_buffer_block_push")
+{
+   auto rb1 = q::ring_buffer<int>{16};
+   auto rb2 = q::ring_buffer<int>{16};
+
+   int data[40];
+   for (int i = 0; i != 40; ++i)
+      data[i] = i * 3;
+
+   // Block pushes of varying sizes, wrapping around the storage
+   std::size_t const sizes[] = { 5, 7, 1, 11, 16 };
+   int const* p = data;
+   for (auto n : sizes)
+   {
+      rb1.push(p, n);
+      for (std::size_t i = 0; i != n; ++i)
+         rb2.push(p[i]);
+      p += n;
+
+      for (std::size_t i = 0; i != rb1.size(); ++i)
+         CHECK(rb1[i] == rb2[i]);
+   }
+
+   // Pushing more than size() elements keeps only the latest
+   rb1.push(data, 40);
+   for (int i = 0; i != 16; ++i)
+      CHECK(rb1[i] == data[39-i]);
+
+   // iterator_range interface
+   rb2.push(cycfi::iterator_range<int const*>{data, data + 40});
+   for (std::size_t i = 0; i != rb1.size(); ++i)
+      CHECK(rb1[i] == rb2[i]);
+}
+
+TEST_CASE("Test_ring_buffer_block_read")
+{
+   auto rb = q::ring_buffer<float>{16};
+   for (int i = 0; i != 27; ++i)
+      rb.push(i);
+
+   // read is the inverse of push
+   float in[5] = { 100, 101, 102, 103, 104 };
+   float out[5];
+   rb.push(in, 5);
+   rb.read(0, out, 5);
+   for (int i = 0; i != 5; ++i)
+      CHECK(out[i] == in[i]);
+
+   // Read a delayed block, crossing the end of the storage
+   float out2[9];
+   rb.read(5, cycfi::iterator_range<float*>{out2, out2 + 9});
+   for (int i = 0; i != 9; ++i)
+      CHECK(out2[i] == rb[5+8-i]);
+}
+
+TEST_CASE("Test_ring_buffer_segments")
+{
+   auto rb = q::ring_buffer<int>{8};
+   for (int i = 0; i != 13; ++i)
+      rb.push(i);
+
+   // Not wrapped
+   {
+      auto [a, b] = rb.segments(0, 5);
+      CHECK(a.end() - a.begin() == 5);
+      CHECK(b.end() - b.begin() == 0);
+      int expected = 8;
+      for (auto e : a)
+         CHECK(e == expected++);
+   }
+
+   // Wrapped
+   {
+      auto const& crb = rb;
+      auto [a, b] = crb.segments(0, 8);
+      CHECK((a.end() - a.begin()) + (b.end() - b.begin()) == 8);
+      int expected = 5;
+      for (auto e : a)
+         CHECK(e == expected++);
+      for (auto e : b)
+         CHECK(e == expected++);
+      CHECK(expected == 13);
+   }
+}
@@ -0,0 +1,79 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/support/literals.hpp>
+#include <q/fx/signal_conditioner.hpp>
+#include <vector>
+#include <random>
+#include <cmath>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+namespace
+{
+   constexpr auto sps = 44100;
+
+   // Plucked string-like test signal: decaying notes with noise and
+   // silent gaps, to exercise the gate and the compressor.
+   std::vector<float> test_signal(std::size_t n)
+   {
+      auto rng = std::mt19937{7};
+      auto dist = std::uniform_real_distribution<float>{-1.0f, 1.0f};
+      std::vector<float> in(n);
+      for (std::size_t i = 0; i != n; ++i)
+      {
+         float t = i % 20000;
+         auto env = (t < 15000)? 0.8f * std::exp(-t / 4000) : 0.0f;
+         in[i] = env * std::sin(i * 0.0187f) + 0.0005f * dist(rng);
+      }
+      return in;
+   }
+}
+
+TEST_CASE("Test_signal_conditioner_block")
+{
+   auto in = test_signal(100000);
+   auto conf = q::signal_conditioner::config{};
+
+   auto sc1 = q::signal_conditioner{conf, 82_Hz, 330_Hz, sps};
+   std::vector<float> expected(in.size());
+   std::vector<float> expected_env(in.size());
+   for (std::size_t i = 0; i != in.size(); ++i)
+   {
+      expected[i] = sc1(in[i]);
+      expected_env[i] = sc1.signal_env();
+   }
+
+   SECTION("Various block sizes")
+   {
+      auto sc2 = q::signal_conditioner{conf, 82_Hz, 330_Hz, sps};
+      std::vector<float> out(in.size());
+      std::size_t sizes[] = { 1, 7, 64, 100, 333 };
+      std::size_t k = 0;
+      for (std::size_t i = 0; i < in.size(); ++k)
+      {
+         auto n = std::min(sizes[k % 5], in.size() - i);
+         sc2.process(in.data() + i, out.data() + i, n);
+         i += n;
+         REQUIRE(sc2.signal_env() == Approx(expected_env[i-1]).margin(1e-6));
+      }
+      CHECK(sc2.gate() == sc1.gate());
+      CHECK(sc2.gate_env() == Approx(sc1.gate_env()));
+      for (std::size_t i = 0; i != in.size(); ++i)
+         REQUIRE(out[i] == Approx(expected[i]).margin(1e-6));
+   }
+
+   SECTION("In-place")
+   {
+      auto sc2 = q::signal_conditioner{conf, 82_Hz, 330_Hz, sps};
+      auto buf = in;
+      sc2.process(buf.data(), buf.data(), buf.size());
+      for (std::size_t i = 0; i != in.size(); ++i)
+         REQUIRE(buf[i] == Approx(expected[i]).margin(1e-6));
+   }
+}
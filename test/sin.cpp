@@ -200,3 +200,91 @@ TEST_CASE("Test_sin_speed")
    CHECK(accu != 0);
 }
 
+
+template <std::size_t N, q::sin_interpolation I>
+void sin_lu_accuracy(char const* name, float max_error)
+{
+   // Phases spread over the cycle (golden ratio increments)
+   double max_diff = 0;
+   double total_diff = 0;
+   constexpr int size = 1000000;
+   auto ph = q::phase{};
+   for (int i = 0; i < size; ++i)
+   {
+      auto r1 = q::sin_lu<N, I>(ph);
+      auto r2 = std::sin(2 * pi * ph.rep / 4294967296.0);
+      auto diff = std::abs(r1 - r2);
+      max_diff = std::max(max_diff, diff);
+      total_diff += diff;
+      ph.rep += 2654435769u;
+   }
+   auto ave_diff = total_diff / size;
+   std::cout << name << " max diff: " << max_diff << std::endl;
+   std::cout << name << " ave diff: " << ave_diff << std::endl;
+
+   CHECK(max_diff < max_error);
+}
+
+template <std::size_t N, q::sin_interpolation I>
+float sin_lu_speed(char const* name)
+{
+   float accu = 0;
+   auto start = std::chrono::high_resolution_clock::now();
+
+   auto ph = q::phase{};
+   for (int i = 0; i < 1024*1024; ++i)
+   {
+      accu += q::sin_lu<N, I>(ph);
+      ph.rep += 2654435769u;
+   }
+
+   auto elapsed = std::chrono::high_resolution_clock::now() - start;
+   auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+
+   std::cout << name << " elapsed (ns): " << float(duration.count()) / (1024*1024) << std::endl;
+   CHECK(duration.count() > 0);
+   return accu;
+}
+
+TEST_CASE("Test_sin_lu_interpolation")
+{
+   using q::sin_interpolation;
+   constexpr auto linear = sin_interpolation::linear;
+   constexpr auto cubic = sin_interpolation::cubic;
+   constexpr auto quadrature = sin_interpolation::quadrature;
+
+   // The default is the same as sin_lu(ph)
+   for (std::uint32_t i = 0; i < 100000; ++i)
+   {
+      auto ph = q::phase(i * 42949u);
+      REQUIRE(q::sin_lu<1024, linear>(ph) == q::sin_lu(ph));
+   }
+
+   // The quarter cycle extension of the table is the cos
+   for (std::uint32_t i = 0; i < 100000; ++i)
+   {
+      auto ph = q::phase(i * 42949u);
+      auto cos_ph = ph + q::phase::middle() / 2;
+      REQUIRE(q::sin_lu<1024, quadrature>(cos_ph) ==
+         Approx(std::cos(2 * pi * ph.rep / 4294967296.0)).margin(2e-7));
+   }
+
+   sin_lu_accuracy<256, linear>("q::sin_lu<256, linear>", 8e-5);
+   sin_lu_accuracy<1024, linear>("q::sin_lu<1024, linear>", 5e-6);
+   sin_lu_accuracy<4096, linear>("q::sin_lu<4096, linear>", 4e-7);
+   sin_lu_accuracy<256, cubic>("q::sin_lu<256, cubic>", 4e-7);
+   sin_lu_accuracy<1024, cubic>("q::sin_lu<1024, cubic>", 3e-7);
+   sin_lu_accuracy<4096, cubic>("q::sin_lu<4096, cubic>", 3e-7);
+   sin_lu_accuracy<64, quadrature>("q::sin_lu<64, quadrature>", 2e-7);
+   sin_lu_accuracy<256, quadrature>("q::sin_lu<256, quadrature>", 2e-7);
+   sin_lu_accuracy<1024, quadrature>("q::sin_lu<1024, quadrature>", 2e-7);
+   sin_lu_accuracy<4096, quadrature>("q::sin_lu<4096, quadrature>", 2e-7);
+
+   // This is here to prevent dead-code elimination
+   float accu = 0;
+   accu += sin_lu_speed<1024, linear>("q::sin_lu<1024, linear>");
+   accu += sin_lu_speed<1024, cubic>("q::sin_lu<1024, cubic>");
+   accu += sin_lu_speed<1024, quadrature>("q::sin_lu<1024, quadrature>");
+   accu += sin_lu_speed<65536, linear>("q::sin_lu<65536, linear>");
+   CHECK(accu != 0);
+}
@@ -0,0 +1,163 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+
+#include <q/support/literals.hpp>
+#include <q/synth/sin_cos_gen_bank.hpp>
+#include <cmath>
+#include <vector>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+constexpr auto sps = 48000;
+constexpr std::size_t lanes = 8;
+
+// From a few Hz up to near Nyquist, well above the sps/6 limit of
+// sin_cos_gen
+constexpr double freqs[lanes] = {
+   1.0, 27.5, 440.0, 1000.0, 7999.0, 12345.0, 20000.0, 23900.0
+};
+
+auto make_bank()
+{
+   auto bank = q::sin_cos_gen_bank<lanes>{};
+   for (std::size_t k = 0; k != lanes; ++k)
+      bank.config(k, q::frequency(freqs[k]), sps);
+   return bank;
+}
+
+TEST_CASE("Test_sin_cos_gen_bank_accuracy")
+{
+   auto bank = make_bank();
+   double max_error = 0.0;
+   for (std::size_t i = 1; i <= sps; ++i)
+   {
+      auto [s, c] = bank();
+      for (std::size_t k = 0; k != lanes; ++k)
+      {
+         double phase = 2_pi * freqs[k] * i / sps;
+         max_error = std::max(max_error, std::abs(s[k] - std::sin(phase)));
+         max_error = std::max(max_error, std::abs(c[k] - std::cos(phase)));
+      }
+   }
+
+   // After one second, the phase error due to the float coefficients is
+   // still well below 1e-3 radians
+   CHECK(max_error < 1e-3);
+}
+
+TEST_CASE("Test_sin_cos_gen_bank_drift")
+{
+   // The amplitude does not drift, even after a long time
+   auto bank = make_bank();
+   for (std::size_t i = 0; i != 100 * sps; ++i)
+   {
+      auto [s, c] = bank();
+      if (i % 1000 == 0)
+      {
+         for (std::size_t k = 0; k != lanes; ++k)
+            REQUIRE(std::hypot(s[k], c[k]) == Approx(1.0f).margin(1e-5));
+      }
+   }
+}
+
+TEST_CASE("Test_sin_cos_gen_bank_block")
+{
+   // The block render is the same as the per-sample frames, for any block
+   // size
+   constexpr std::size_t n = 5000;
+   auto ref = make_bank();
+   std::vector<float> ref_sin(n * lanes), ref_cos(n * lanes);
+   for (std::size_t i = 0; i != n; ++i)
+   {
+      auto [s, c] = ref();
+      for (std::size_t k = 0; k != lanes; ++k)
+      {
+         ref_sin[k * n + i] = s[k];
+         ref_cos[k * n + i] = c[k];
+      }
+   }
+
+   for (std::size_t block : { 1, 7, 32, 33, 100, 5000 })
+   {
+      auto bank = make_bank();
+      std::vector<float> out_sin(n * lanes), out_cos(n * lanes);
+      for (std::size_t i = 0; i < n; i += block)
+      {
+         q::sin_cos_gen_bank<lanes>::out_channels sin_ch, cos_ch;
+         for (std::size_t k = 0; k != lanes; ++k)
+         {
+            sin_ch[k] = out_sin.data() + k * n + i;
+            cos_ch[k] = out_cos.data() + k * n + i;
+         }
+         bank.render(sin_ch, cos_ch, std::min(block, n - i));
+      }
+      CHECK(out_sin == ref_sin);
+      CHECK(out_cos == ref_cos);
+   }
+}
+
+TEST_CASE("Test_sin_cos_gen_bank_phase")
+{
+   auto bank = q::sin_cos_gen_bank<lanes>{ 1_kHz, sps };
+   bank.phase(1, 1_pi / 2);
+   bank.phase(2, 1_pi);
+   CHECK(bank.sin()[0] == 0.0f);
+   CHECK(bank.cos()[0] == 1.0f);
+   CHECK(bank.sin()[1] == Approx(1.0f));
+   CHECK(bank.cos()[2] == Approx(-1.0f));
+
+   // Changing the frequency keeps the phase
+   for (int i = 0; i != 10; ++i)
+      bank();
+   auto s = bank.sin()[0];
+   auto c = bank.cos()[0];
+   bank.config(0, 2_kHz, sps);
+   CHECK(bank.sin()[0] == s);
+   CHECK(bank.cos()[0] == c);
+
+   bank.reset();
+   for (std::size_t k = 0; k != lanes; ++k)
+   {
+      CHECK(bank.sin()[k] == 0.0f);
+      CHECK(bank.cos()[k] == 1.0f);
+   }
+}
+
+TEST_CASE("Test_sin_cos_gen_bank_many_lanes")
+{
+   // More lanes than the block render processes at a time
+   constexpr std::size_t many = 80;
+   constexpr std::size_t n = 1000;
+   auto ref = q::sin_cos_gen_bank<many>{};
+   auto bank = q::sin_cos_gen_bank<many>{};
+   for (std::size_t k = 0; k != many; ++k)
+   {
+      ref.config(k, q::frequency(100.0 + k * 250), sps);
+      bank.config(k, q::frequency(100.0 + k * 250), sps);
+   }
+
+   std::vector<float> out_sin(n * many), out_cos(n * many);
+   q::sin_cos_gen_bank<many>::out_channels sin_ch, cos_ch;
+   for (std::size_t k = 0; k != many; ++k)
+   {
+      sin_ch[k] = out_sin.data() + k * n;
+      cos_ch[k] = out_cos.data() + k * n;
+   }
+   bank.render(sin_ch, cos_ch, n);
+
+   for (std::size_t i = 0; i != n; ++i)
+   {
+      auto [s, c] = ref();
+      for (std::size_t k = 0; k != many; ++k)
+      {
+         REQUIRE(sin_ch[k][i] == s[k]);
+         REQUIRE(cos_ch[k][i] == c[k]);
+      }
+   }
+}
@@ -0,0 +1,175 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+#include <q/utility/spsc_ring_buffer.hpp>
+#include <thread>
+#include <chrono>
+#include <iostream>
+
+namespace q = cycfi::q;
+
+TEST_CASE("Test_spsc_ring_buffer_basic")
+{
+   auto rb = q::spsc_ring_buffer<int>{6};
+   CHECK(rb.capacity() == 8);
+   CHECK(rb.empty());
+
+   for (int i = 0; i != 8; ++i)
+      CHECK(rb.push(i));
+   CHECK(!rb.push(8));        // full
+   CHECK(rb.size() == 8);
+
+   int val;
+   for (int i = 0; i != 8; ++i)
+   {
+      CHECK(rb.pop(val));
+      CHECK(val == i);
+   }
+   CHECK(!rb.pop(val));       // empty
+   CHECK(rb.empty());
+}
+
+TEST_CASE("Test_spsc_ring_buffer_block")
+{
+   auto rb = q::spsc_ring_buffer<float, std::array<float, 16>>{};
+
+   float in[24];
+   for (int i = 0; i != 24; ++i)
+      in[i] = i;
+
+   CHECK(rb.push(in, 10) == 10);
+   float out[24];
+   CHECK(rb.pop(out, 7) == 7);
+   for (int i = 0; i != 7; ++i)
+      CHECK(out[i] == i);
+
+   // Wraps around; only 13 elements can be pushed
+   CHECK(rb.push(in + 10, 14) == 13);
+   CHECK(rb.write_available() == 0);
+   CHECK(rb.read_available() == 16);
+
+   CHECK(rb.discard(2) == 2);
+   CHECK(rb.pop(cycfi::iterator_range<float*>{out, out + 24}) == 14);
+   for (int i = 0; i != 14; ++i)
+      CHECK(out[i] == i + 9);
+   CHECK(rb.empty());
+}
+
+// The producer and consumer yield when they make no progress, so that the
+// tests also run fast on a single CPU.
+TEST_CASE("Test_spsc_ring_buffer_stress")
+{
+   constexpr std::size_t count = 4'000'000;
+   auto rb = q::spsc_ring_buffer<std::uint32_t>{1024};
+   bool in_order = true;
+
+   std::thread consumer{
+      [&]
+      {
+         std::uint32_t buff[97];
+         std::uint32_t expected = 0;
+         while (expected != count)
+         {
+            // Alternate between single and block pops
+            if (expected % 2)
+            {
+               std::uint32_t val;
+               if (rb.pop(val))
+                  in_order &= (val == expected++);
+               else
+                  std::this_thread::yield();
+            }
+            else
+            {
+               auto n = rb.pop(buff, 1 + (expected % 97));
+               for (std::size_t i = 0; i != n; ++i)
+                  in_order &= (buff[i] == expected++);
+               if (n == 0)
+                  std::this_thread::yield();
+            }
+         }
+      }
+   };
+
+   std::uint32_t buff[61];
+   std::uint32_t next = 0;
+   while (next != count)
+   {
+      // Alternate between single and block pushes
+      if (next % 3 == 0)
+      {
+         if (rb.push(next))
+            ++next;
+         else
+            std::this_thread::yield();
+      }
+      else
+      {
+         auto n = std::min<std::size_t>(1 + (next % 61), count - next);
+         for (std::size_t i = 0; i != n; ++i)
+            buff[i] = next + i;
+         auto pushed = rb.push(buff, n);
+         next += pushed;
+         if (pushed == 0)
+            std::this_thread::yield();
+      }
+   }
+
+   consumer.join();
+   CHECK(in_order);
+   CHECK(rb.empty());
+}
+
+TEST_CASE("Test_spsc_ring_buffer_throughput")
+{
+   constexpr std::size_t block_size = 256;
+   constexpr std::size_t blocks = 20'000;
+   auto rb = q::spsc_ring_buffer<float>{block_size * 16};
+
+   auto start = std::chrono::high_resolution_clock::now();
+
+   std::thread consumer{
+      [&]
+      {
+         float buff[block_size];
+         std::size_t received = 0;
+         while (received != block_size * blocks)
+         {
+            auto n = rb.pop(buff, block_size);
+            received += n;
+            if (n == 0)
+               std::this_thread::yield();
+         }
+      }
+   };
+
+   float buff[block_size] = {};
+   for (std::size_t i = 0; i != blocks; ++i)
+   {
+      std::size_t n = 0;
+      while (n != block_size)
+      {
+         auto pushed = rb.push(buff + n, block_size - n);
+         n += pushed;
+         if (pushed == 0)
+            std::this_thread::yield();
+      }
+   }
+   consumer.join();
+
+   auto stop = std::chrono::high_resolution_clock::now();
+   std::chrono::duration<double> elapsed = stop - start;
+   auto samples_per_sec = (block_size * blocks) / elapsed.count();
+
+   std::cout
+      << "spsc_ring_buffer throughput ("
+      << block_size << " sample blocks): "
+      << samples_per_sec / 1e6 << " MSamples/s"
+      << std::endl;
+
+   CHECK(rb.empty());
+}
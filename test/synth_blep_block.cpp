@@ -0,0 +1,84 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+
+#include <q/support/literals.hpp>
+#include <q/synth/saw_synth.hpp>
+#include <q/synth/square_synth.hpp>
+#include <q/synth/pulse_synth.hpp>
+#include <vector>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+constexpr auto sps = 48000;
+
+// The block render must match the per-sample synth exactly, for any
+// frequency (including ones above Nyquist), start phase and block size.
+template <typename Synth>
+void check_block(Synth const& synth, q::frequency f, q::phase start)
+{
+   constexpr std::size_t blocks[] = { 1, 2, 3, 7, 32, 61, 64, 256, 1000 };
+   constexpr std::size_t size = 8192;
+
+   auto ref_it = q::phase_iterator{f, sps};
+   ref_it = start;
+   std::vector<float> ref(size);
+   for (auto& s : ref)
+      s = synth(ref_it++);
+
+   auto it = q::phase_iterator{f, sps};
+   it = start;
+   std::vector<float> out(size);
+   std::size_t i = 0;
+   for (std::size_t b = 0; i != size; ++b)
+   {
+      auto n = std::min(blocks[b % std::size(blocks)], size - i);
+      synth.render(it, out.data() + i, n);
+      i += n;
+   }
+
+   for (std::size_t k = 0; k != size; ++k)
+   {
+      INFO("sample " << k);
+      REQUIRE(out[k] == ref[k]);
+   }
+   CHECK(it._phase.rep == ref_it._phase.rep);
+}
+
+template <typename Synth>
+void check_synth(Synth const& synth)
+{
+   q::frequency const freqs[] = {
+      0_Hz, 1_Hz, 27.5_Hz, 440_Hz, 1234.5_Hz, 5000_Hz
+    , 12000_Hz, 23999_Hz, 24000_Hz, 30000_Hz
+   };
+   q::phase const starts[] = {
+      q::phase{}, q::phase::middle(), q::phase::end(), q::phase(0.3f)
+   };
+
+   for (auto f : freqs)
+      for (auto p : starts)
+         check_block(synth, f, p);
+}
+
+TEST_CASE("Test_saw_block")
+{
+   check_synth(q::saw);
+}
+
+TEST_CASE("Test_square_block")
+{
+   check_synth(q::square);
+}
+
+TEST_CASE("Test_pulse_block")
+{
+   check_synth(q::pulse);
+   check_synth(q::pulse_synth{0.1f});
+   check_synth(q::pulse_synth{0.75f});
+}
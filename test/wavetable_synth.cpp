@@ -0,0 +1,131 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+
+#include <q/support/literals.hpp>
+#include <q/synth/wavetable_synth.hpp>
+#include <q/synth/saw_synth.hpp>
+#include <q/synth/sin_synth.hpp>
+#include <cmath>
+#include <vector>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+
+constexpr auto sps = 48000;
+constexpr std::size_t table_size = 2048;
+using wavetable = q::wavetable_synth<table_size>;
+
+// Band-limited saw (same as basic_saw, with harmonics up to max_h)
+double additive_saw(double x, std::size_t max_h)
+{
+   double y = 0.0;
+   for (std::size_t h = 1; h <= max_h; ++h)
+      y -= std::sin(2_pi * h * x) / h;
+   return y * 2 / q::pi;
+}
+
+TEST_CASE("Test_wavetable_sin")
+{
+   // A sine has the fundamental only, so all the levels are the same
+   auto synth = wavetable{ q::sin };
+   for (std::size_t k = 0; k != wavetable::levels; ++k)
+   {
+      auto const* table = synth.table(k);
+      for (std::size_t i = 0; i <= table_size; ++i)
+         REQUIRE(table[i] == Approx(std::sin(2_pi * i / table_size)).margin(1e-5));
+   }
+}
+
+TEST_CASE("Test_wavetable_saw_levels")
+{
+   // A saw with all the harmonics that fit the table
+   std::vector<float> cycle(table_size);
+   for (std::size_t i = 0; i != table_size; ++i)
+      cycle[i] = additive_saw(double(i) / table_size, table_size / 2 - 1);
+   auto synth = wavetable{ cycle.data() };
+
+   // Level k has the harmonics up to (N/2) >> k
+   for (std::size_t k = 0; k != wavetable::levels; ++k)
+   {
+      auto const* table = synth.table(k);
+      auto const max_h = std::min((table_size / 2) >> k, table_size / 2 - 1);
+      for (std::size_t i = 0; i < table_size; i += 7)
+      {
+         auto x = double(i) / table_size;
+         REQUIRE(table[i] == Approx(additive_saw(x, max_h)).margin(1e-4));
+      }
+   }
+}
+
+TEST_CASE("Test_wavetable_mip_level")
+{
+   // Level 0 at low frequencies
+   CHECK(wavetable::mip_level(q::phase(10_Hz, sps)) == 0.0f);
+   CHECK(wavetable::mip_level(q::phase()) == 0.0f);
+
+   // The levels are exact at powers of 2
+   constexpr auto shift = q::phase::bits - q::detail::ilog2(table_size) - 1;
+   for (int k = 1; k != int(wavetable::levels); ++k)
+   {
+      auto dt = q::phase(std::uint32_t(1) << (shift + k));
+      CHECK(wavetable::mip_level(dt) == float(k));
+   }
+
+   // The highest harmonic of the brighter of the two crossfaded levels is
+   // always below Nyquist
+   float prev = 0.0f;
+   for (float f = 10; f < 24000; f *= 1.01)
+   {
+      auto dt = q::phase(q::frequency(f), sps);
+      auto level = wavetable::mip_level(dt);
+      REQUIRE(level >= prev);
+      prev = level;
+
+      auto k = std::size_t(level);
+      auto max_h = std::min((table_size / 2) >> k, table_size / 2 - 1);
+      REQUIRE(max_h * f < sps / 2);
+   }
+   CHECK(prev == float(wavetable::levels - 1));
+}
+
+TEST_CASE("Test_wavetable_block")
+{
+   auto synth = wavetable{ q::basic_saw };
+   q::frequency const freqs[] = { 0_Hz, 27.5_Hz, 440_Hz, 1000_Hz, 3520_Hz, 15000_Hz, 30000_Hz };
+   constexpr std::size_t size = 4096;
+
+   for (auto f : freqs)
+   {
+      auto ref_it = q::phase_iterator{f, sps};
+      std::vector<float> ref(size);
+      for (auto& s : ref)
+         s = synth(ref_it++);
+
+      auto it = q::phase_iterator{f, sps};
+      std::vector<float> out(size);
+      for (std::size_t i = 0; i < size; i += 100)
+         synth.render(it, out.data() + i, std::min<std::size_t>(100, size - i));
+
+      for (std::size_t i = 0; i != size; ++i)
+         REQUIRE(out[i] == ref[i]);
+      CHECK(it._phase.rep == ref_it._phase.rep);
+   }
+}
+
+TEST_CASE("Test_wavetable_from_samples")
+{
+   std::vector<float> cycle(table_size);
+   for (std::size_t i = 0; i != table_size; ++i)
+      cycle[i] = q::basic_saw(q::phase(std::uint32_t(i) << 21));
+
+   auto a = wavetable{ cycle.data() };
+   auto b = wavetable{ q::basic_saw };
+   for (std::size_t k = 0; k != wavetable::levels; ++k)
+      for (std::size_t i = 0; i <= table_size; ++i)
+         REQUIRE(a.table(k)[i] == b.table(k)[i]);
+}
@@ -0,0 +1,166 @@
+/*=============================================================================
+   Copyright (c) 2014-2023 Joel de Guzman. All rights reserved.
+
+   Distributed under the MIT License [ https://opensource.org/licenses/MIT ]
+=============================================================================*/
+#define CATCH_CONFIG_MAIN
+#include <infra/catch.hpp>
+
+#include <q/support/literals.hpp>
+#include <q/fft/window.hpp>
+#include <q/fft/fft.hpp>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+namespace q = cycfi::q;
+using namespace q::literals;
+using q::window_type;
+
+// Highest side lobe in dB, relative to the main lobe, given the main lobe
+// half width in bins. The window's spectrum is evaluated on a fine grid.
+double side_lobe_level(q::window_table const& w, double main_lobe)
+{
+   auto const n = w.size();
+   auto response = [&](double bin)
+   {
+      std::complex<double> sum = 0.0;
+      for (std::size_t i = 0; i != n; ++i)
+         sum += double(w[i]) * std::polar(1.0, double(-2_pi * bin * i / n));
+      return std::abs(sum);
+   };
+
+   auto const peak = response(0.0);
+   double max = 0.0;
+   for (double bin = main_lobe; bin < n / 2; bin += 1.0 / 16)
+      max = std::max(max, response(bin));
+   return 20 * std::log10(max / peak);
+}
+
+TEST_CASE("Test_window_values")
+{
+   constexpr std::size_t n = 480;
+   auto const& hann = q::window({ window_type::hann, n });
+   auto const& hamming = q::window({ window_type::hamming, n });
+   auto const& blackman = q::window({ window_type::blackman, n, true });
+
+   for (std::size_t i = 0; i != n; ++i)
+   {
+      auto x = 2_pi * i / n;
+      auto xs = 2_pi * i / (n - 1);
+      REQUIRE(hann[i] == Approx(0.5 - 0.5 * std::cos(x)).margin(1e-7));
+      REQUIRE(hamming[i] == Approx(0.54 - 0.46 * std::cos(x)).margin(1e-7));
+      REQUIRE(blackman[i] ==
+         Approx(0.42 - 0.5 * std::cos(xs) + 0.08 * std::cos(2 * xs)).margin(1e-7));
+   }
+
+   // The periodic Hann window with 50% overlap adds up to 1
+   for (std::size_t i = 0; i != n / 2; ++i)
+      REQUIRE(hann[i] + hann[i + n / 2] == Approx(1.0f).margin(1e-7));
+}
+
+TEST_CASE("Test_window_symmetry")
+{
+   window_type const types[] = {
+      window_type::hann, window_type::hamming, window_type::blackman
+    , window_type::blackman_harris, window_type::nuttall
+    , window_type::flat_top, window_type::kaiser
+   };
+
+   for (auto type : types)
+   {
+      for (std::size_t n : { 63, 64 })
+      {
+         // Periodic: w[i] == w[n - i]
+         auto periodic = q::window_table({ type, n });
+         for (std::size_t i = 1; i != n; ++i)
+            REQUIRE(periodic[i] == Approx(periodic[n - i]).margin(1e-6));
+
+         // Symmetric: w[i] == w[n - 1 - i]
+         auto symmetric = q::window_table({ type, n, true });
+         for (std::size_t i = 0; i != n; ++i)
+            REQUIRE(symmetric[i] == Approx(symmetric[n - 1 - i]).margin(1e-6));
+         if (n % 2)
+            CHECK(symmetric[n / 2] == Approx(1.0f).margin(1e-6));
+      }
+   }
+
+   // Kaiser with beta = 0 is the rectangular window
+   auto rect = q::window_table({ window_type::kaiser, 64, false, 0.0f });
+   for (auto w : rect)
+      REQUIRE(w == 1.0f);
+}
+
+TEST_CASE("Test_window_gain")
+{
+   // The coherent gain of the periodic cosine-sum windows is a0
+   constexpr std::size_t n = 1024;
+   CHECK(q::window({ window_type::hann, n }).coherent_gain() == Approx(0.5));
+   CHECK(q::window({ window_type::hamming, n }).coherent_gain() == Approx(0.54));
+   CHECK(q::window({ window_type::blackman, n }).coherent_gain() == Approx(0.42));
+   CHECK(q::window({ window_type::blackman_harris, n }).coherent_gain() == Approx(0.35875));
+   CHECK(q::window({ window_type::nuttall, n }).coherent_gain() == Approx(0.355768));
+   CHECK(q::window({ window_type::flat_top, n }).coherent_gain() == Approx(0.21557895));
+}
+
+TEST_CASE("Test_window_side_lobes")
+{
+   constexpr std::size_t n = 128;
+   CHECK(side_lobe_level(q::window({ window_type::hann, n }), 2) < -31);
+   CHECK(side_lobe_level(q::window({ window_type::hamming, n }), 2) < -42);
+   CHECK(side_lobe_level(q::window({ window_type::blackman, n }), 3) < -58);
+   CHECK(side_lobe_level(q::window({ window_type::blackman_harris, n }), 4) < -92);
+   CHECK(side_lobe_level(q::window({ window_type::nuttall, n }), 4) < -93);
+   CHECK(side_lobe_level(q::window({ window_type::flat_top, n }), 5) < -90);
+   CHECK(side_lobe_level(q::window({ window_type::kaiser, n }), 3) < -63);
+   CHECK(side_lobe_level(q::window({ window_type::kaiser, n, false, 12.0f }), 4) < -89);
+}
+
+TEST_CASE("Test_window_flat_top")
+{
+   // The flat top window measures the amplitude of a sine between two
+   // bins within 0.01 dB
+   constexpr std::size_t n = 1024;
+   auto const& w = q::window({ window_type::flat_top, n });
+   for (double bin : { 100.0, 100.25, 100.5 })
+   {
+      std::vector<double> data(n * 2, 0.0);
+      for (std::size_t i = 0; i != n; ++i)
+         data[i * 2] = 0.5 * std::cos(double(2_pi * bin * i / n)) * w[i];
+      q::fft<n>(data.data());
+
+      double peak = 0.0;
+      for (std::size_t i = 90; i != 110; ++i)
+         peak = std::max(peak, std::hypot(data[i * 2], data[i * 2 + 1]));
+      auto amplitude = 2 * peak / (n * w.coherent_gain());
+      CHECK(20 * std::log10(amplitude / 0.5) == Approx(0.0).margin(0.01));
+   }
+}
+
+TEST_CASE("Test_window_cache_and_apply")
+{
+   auto const& a = q::window({ window_type::hann, 1024 });
+   auto const& b = q::window({ window_type::hann, 1024 });
+   auto const& c = q::window({ window_type::hann, 2048 });
+   auto const& d = q::window({ window_type::kaiser, 1024, false, 4.0f });
+   auto const& e = q::window({ window_type::kaiser, 1024, false, 8.0f });
+   CHECK(&a == &b);
+   CHECK(&a != &c);
+   CHECK(&d != &e);
+   CHECK(e.spec().beta == 8.0f);
+
+   for (auto const* w : { &a, &c, &d, &e })
+      CHECK(std::uintptr_t(w->data()) % q::window_table::alignment == 0);
+
+   std::vector<float> in(1024), out(1024);
+   for (std::size_t i = 0; i != in.size(); ++i)
+      in[i] = std::sin(i * 0.1f);
+   a.apply(in.data(), out.data());
+   for (std::size_t i = 0; i != in.size(); ++i)
+      REQUIRE(out[i] == in[i] * a[i]);
+
+   // In place
+   a.apply(in.data(), in.data());
+   CHECK(in == out);
+}